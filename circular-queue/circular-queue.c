@@ -2,15 +2,19 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /**
  * A circlular queue: a first-in-first-out data structure with a fixed buffer
- * size.
+ * size. In overwrite mode, adding to a full queue will drop its oldest element
+ * instead of failing.
  */
 typedef struct CircularQueue {
   int size;
   int readPos; // Will be `-1` when the queue is empty
   int writePos;
+  bool overwrite;
+  long long dropped; // Elements lost to overwrites
   int array[];
 } CircularQueue;
 
@@ -29,10 +33,21 @@ CircularQueue *newCircularQueue(int bufferSize) {
   ptr->size = bufferSize;
   ptr->readPos = -1;
   ptr->writePos = 0;
+  ptr->overwrite = false;
+  ptr->dropped = 0;
 
   return ptr;
 }
 
+/** Returns the number of elements in a circular queue. */
+int size(CircularQueue *queue) {
+  if (queue->readPos == -1)
+    return 0;
+
+  int length = (queue->writePos - queue->readPos + queue->size) % queue->size;
+  return length == 0 ? queue->size : length;
+}
+
 /** Returns whether or not a circular queue is empty. */
 bool isEmpty(CircularQueue *queue) { return queue->readPos == -1; }
 
@@ -40,17 +55,36 @@ bool isEmpty(CircularQueue *queue) { return queue->readPos == -1; }
 bool isFull(CircularQueue *queue) { return queue->readPos == queue->writePos; }
 
 /**
- * Adds an element to a circular queue if the queue is not already full.
+ * Turns overwrite mode on or off for a circular queue. While it is on, adding
+ * elements to a full queue (with `enqueue` or `enqueueMany`) will drop the
+ * oldest elements to make room.
+ */
+void setOverwrite(CircularQueue *queue, bool overwrite) {
+  queue->overwrite = overwrite;
+}
+
+/**
+ * Adds an element to a circular queue if the queue is not already full. In
+ * overwrite mode, a full queue will instead drop its oldest element.
  *
  * @param queue A pointer to the circular queue.
  * @param element The element to add.
  * @return `0` if the element was successfully added, `1` if the circular queue
- *   was already full.
+ *   was already full (and not in overwrite mode).
  */
 int enqueue(CircularQueue *queue, int element) {
   if (isFull(queue)) {
-    printf("Enqueue error: circular queue is already full.\n");
-    return 1;
+    if (!queue->overwrite) {
+      printf("Enqueue error: circular queue is already full.\n");
+      return 1;
+    }
+
+    // Drop the oldest element; the read position follows the write position
+    queue->array[queue->writePos] = element;
+    queue->writePos = (queue->writePos + 1) % queue->size;
+    queue->readPos = queue->writePos;
+    queue->dropped++;
+    return 0;
   }
 
   if (isEmpty(queue))
@@ -85,6 +119,151 @@ int *dequeue(CircularQueue *queue) {
   return ptr;
 }
 
+/**
+ * Adds as many elements from an array to a circular queue as will fit, copying
+ * them in at most two contiguous runs (one up to the end of the buffer, one
+ * from its start). In overwrite mode, every element is added, and the oldest
+ * elements (including the earliest of the new ones, if there are more than the
+ * queue can hold) are dropped to make room, as with `enqueue`.
+ *
+ * @param queue A pointer to the circular queue.
+ * @param elements A pointer to the first element to add.
+ * @param count The number of elements in `elements`.
+ * @return The number of elements added, which will be less than `count` if the
+ *   circular queue ran out of space (and is not in overwrite mode).
+ */
+int enqueueMany(CircularQueue *queue, int *elements, int count) {
+  if (count <= 0)
+    return 0;
+
+  int added = count;
+  int space = queue->size - size(queue);
+  if (queue->overwrite) {
+    // Only the newest elements that fit can survive
+    if (count > queue->size) {
+      queue->dropped += count - queue->size;
+      elements += count - queue->size;
+      count = queue->size;
+    }
+
+    // Drop the oldest elements to make room for the rest
+    if (count > space) {
+      queue->dropped += count - space;
+      queue->readPos = (queue->readPos + count - space) % queue->size;
+      if (queue->readPos == queue->writePos)
+        queue->readPos = -1;
+    }
+  } else if (count > space) {
+    count = added = space;
+    if (count == 0)
+      return 0;
+  }
+
+  if (isEmpty(queue))
+    queue->readPos = queue->writePos;
+
+  int firstRun = queue->size - queue->writePos;
+  if (firstRun > count)
+    firstRun = count;
+  memcpy(&queue->array[queue->writePos], elements, firstRun * sizeof(int));
+  memcpy(queue->array, elements + firstRun, (count - firstRun) * sizeof(int));
+
+  queue->writePos = (queue->writePos + count) % queue->size;
+
+  return added;
+}
+
+/**
+ * Removes up to a given number of elements from a circular queue, copying them
+ * in read order into a caller-supplied buffer in at most two contiguous runs.
+ *
+ * @param queue A pointer to the circular queue.
+ * @param buffer A pointer to the array that will receive the elements.
+ * @param maxCount The maximum number of elements to remove (and the minimum
+ *   capacity of `buffer`).
+ * @return The number of elements removed.
+ */
+int dequeueMany(CircularQueue *queue, int *buffer, int maxCount) {
+  int count = size(queue);
+  if (count > maxCount)
+    count = maxCount;
+  if (count <= 0)
+    return 0;
+
+  int firstRun = queue->size - queue->readPos;
+  if (firstRun > count)
+    firstRun = count;
+  memcpy(buffer, &queue->array[queue->readPos], firstRun * sizeof(int));
+  memcpy(buffer + firstRun, queue->array, (count - firstRun) * sizeof(int));
+
+  queue->readPos = (queue->readPos + count) % queue->size;
+  if (queue->readPos == queue->writePos)
+    queue->readPos = -1;
+
+  return count;
+}
+
+/**
+ * Returns the number of free slots that can be written contiguously, starting
+ * at the write position of a circular queue.
+ */
+static int contiguousSpace(CircularQueue *queue) {
+  if (isEmpty(queue) || queue->readPos < queue->writePos)
+    return queue->size - queue->writePos;
+
+  return queue->readPos - queue->writePos;
+}
+
+/**
+ * Reserves a run of contiguous free slots at the write end of a circular queue
+ * so that they can be filled in place. Reserved slots don't become part of the
+ * queue until they are published with `commit`.
+ *
+ * @param queue A pointer to the circular queue.
+ * @param count A pointer to the number of slots wanted. Will be updated to the
+ *   number of slots actually reserved, which may be fewer if there isn't enough
+ *   free space before the end of the buffer.
+ * @return A pointer to the first reserved slot, or `NULL` if the circular queue
+ *   is full.
+ */
+int *reserve(CircularQueue *queue, int *count) {
+  int space = contiguousSpace(queue);
+  if (*count > space)
+    *count = space;
+  if (*count <= 0) {
+    *count = 0;
+    return NULL;
+  }
+
+  return &queue->array[queue->writePos];
+}
+
+/**
+ * Publishes slots previously filled in place through `reserve`, adding them to
+ * the end of a circular queue.
+ *
+ * @param queue A pointer to the circular queue.
+ * @param count The number of reserved slots to publish.
+ * @return `0` if the slots were successfully published, `1` if `count` was
+ *   greater than the number of slots that could have been reserved.
+ */
+int commit(CircularQueue *queue, int count) {
+  if (count < 0 || count > contiguousSpace(queue)) {
+    printf("Commit error: more slots than could have been reserved.\n");
+    return 1;
+  }
+
+  if (count == 0)
+    return 0;
+
+  if (isEmpty(queue))
+    queue->readPos = queue->writePos;
+
+  queue->writePos = (queue->writePos + count) % queue->size;
+
+  return 0;
+}
+
 /** Clears the contents of a circular queue. */
 void clear(CircularQueue *queue) {
   queue->readPos = -1;
@@ -136,6 +315,67 @@ int main() {
 
   enqueue(q, 1);
   assert(*dequeue(q) == 1);
+  assert(size(q) == 0);
+
+  // Batch operations across the wrap point
+  int batch[] = {10, 11, 12, 13, 14, 15};
+  assert(enqueueMany(q, batch, 6) == 5);
+  assert(isFull(q));
+  assert(size(q) == 5);
+  assert(enqueueMany(q, batch, 1) == 0);
+
+  int out[5];
+  assert(dequeueMany(q, out, 3) == 3);
+  assert(out[0] == 10 && out[1] == 11 && out[2] == 12);
+  assert(enqueueMany(q, batch, 2) == 2);
+  assert(dequeueMany(q, out, 5) == 4);
+  assert(out[0] == 13 && out[1] == 14 && out[2] == 10 && out[3] == 11);
+  assert(isEmpty(q));
+  assert(dequeueMany(q, out, 5) == 0);
+
+  // In-place writes through reserve/commit
+  clear(q);
+  enqueue(q, 7);
+  dequeue(q);
+  int count = 10;
+  int *slots = reserve(q, &count);
+  assert(count == 4);
+  slots[0] = 20;
+  slots[1] = 21;
+  assert(commit(q, 5) == 1);
+  assert(commit(q, 2) == 0);
+  assert(size(q) == 2);
+  assert(*dequeue(q) == 20);
+  assert(*dequeue(q) == 21);
+  enqueueMany(q, batch, 5);
+  count = 1;
+  assert(reserve(q, &count) == NULL);
+  assert(count == 0);
+
+  // Overwrite mode drops the oldest elements
+  clear(q);
+  setOverwrite(q, true);
+  for (int i = 0; i < 8; i++) {
+    assert(enqueue(q, i) == 0);
+  }
+  assert(isFull(q));
+  assert(q->dropped == 3);
+  assert(*dequeue(q) == 3);
+  assert(enqueueMany(q, batch, 2) == 2);
+  assert(q->dropped == 4);
+  assert(dequeueMany(q, out, 5) == 5);
+  assert(out[0] == 5 && out[3] == 10 && out[4] == 11);
+
+  // A batch bigger than the queue keeps only its newest elements
+  enqueue(q, 1);
+  assert(enqueueMany(q, batch, 6) == 6);
+  assert(q->dropped == 6);
+  assert(dequeueMany(q, out, 5) == 5);
+  assert(out[0] == 11 && out[4] == 15);
+  assert(isEmpty(q));
+  setOverwrite(q, false);
+  enqueueMany(q, batch, 5);
+  assert(enqueue(q, 9) == 1);
 
   free(q);
   printf("All tests passed successfully.\n");
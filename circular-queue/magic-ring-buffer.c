@@ -0,0 +1,263 @@
+#define _GNU_SOURCE
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/**
+ * A "magic" ring buffer: a circular byte queue whose buffer is mapped into
+ * virtual memory twice, back to back, so that `buffer[i]` and
+ * `buffer[i + size]` refer to the same physical byte. Any run of readable or
+ * writable bytes is therefore contiguous in memory, even when it wraps around
+ * the end of the buffer. (Linux only, since it relies on `memfd_create`.)
+ */
+typedef struct MagicRingBuffer {
+  size_t size;
+  size_t readPos;
+  size_t length;
+  unsigned char *buffer;
+} MagicRingBuffer;
+
+/**
+ * Constructs a new instance of a magic ring buffer and returns a pointer to it.
+ * The buffer size will be rounded up to a multiple of the system page size.
+ * (Make sure to `destroy` the ring buffer once you're finished with it.)
+ */
+MagicRingBuffer *newMagicRingBuffer(size_t minSize) {
+  if (minSize < 1) {
+    printf("Error: buffer size must be positive.\n");
+    return NULL;
+  }
+
+  size_t pageSize = sysconf(_SC_PAGESIZE);
+  size_t size = (minSize + pageSize - 1) / pageSize * pageSize;
+
+  int fd = memfd_create("magic-ring-buffer", 0);
+  if (fd == -1) {
+    printf("Error: could not create memory file.\n");
+    return NULL;
+  }
+  if (ftruncate(fd, size) == -1) {
+    printf("Error: could not size memory file.\n");
+    close(fd);
+    return NULL;
+  }
+
+  // Reserve twice the address space, then map the same file over both halves
+  unsigned char *base =
+      mmap(NULL, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    printf("Error: could not reserve address space.\n");
+    close(fd);
+    return NULL;
+  }
+  if (mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) ==
+          MAP_FAILED ||
+      mmap(base + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+           fd, 0) == MAP_FAILED) {
+    printf("Error: could not map buffer.\n");
+    munmap(base, 2 * size);
+    close(fd);
+    return NULL;
+  }
+
+  // The mappings keep the memory alive on their own
+  close(fd);
+
+  MagicRingBuffer *ptr = malloc(sizeof(MagicRingBuffer));
+
+  ptr->size = size;
+  ptr->readPos = 0;
+  ptr->length = 0;
+  ptr->buffer = base;
+
+  return ptr;
+}
+
+/** Returns the number of bytes in a magic ring buffer. */
+size_t size(MagicRingBuffer *ring) { return ring->length; }
+
+/** Returns whether or not a magic ring buffer is empty. */
+bool isEmpty(MagicRingBuffer *ring) { return size(ring) == 0; }
+
+/** Returns whether or not a magic ring buffer is full. */
+bool isFull(MagicRingBuffer *ring) { return size(ring) == ring->size; }
+
+/**
+ * Reserves a contiguous run of free bytes at the write end of a magic ring
+ * buffer so that they can be filled in place. Reserved bytes don't become part
+ * of the buffer until they are published with `commit`.
+ *
+ * @param ring A pointer to the magic ring buffer.
+ * @param count The number of bytes wanted.
+ * @return A pointer to the first reserved byte, or `NULL` if the ring buffer
+ *   doesn't have `count` free bytes.
+ */
+unsigned char *reserve(MagicRingBuffer *ring, size_t count) {
+  if (count > ring->size - ring->length)
+    return NULL;
+
+  return ring->buffer + (ring->readPos + ring->length) % ring->size;
+}
+
+/**
+ * Publishes bytes previously filled in place through `reserve`, adding them to
+ * the end of a magic ring buffer.
+ *
+ * @param ring A pointer to the magic ring buffer.
+ * @param count The number of reserved bytes to publish.
+ * @return `0` if the bytes were successfully published, `1` if the ring buffer
+ *   doesn't have `count` free bytes.
+ */
+int commit(MagicRingBuffer *ring, size_t count) {
+  if (count > ring->size - ring->length) {
+    printf("Commit error: more bytes than could have been reserved.\n");
+    return 1;
+  }
+
+  ring->length += count;
+  return 0;
+}
+
+/**
+ * Returns a pointer to all readable bytes in a magic ring buffer, as a single
+ * contiguous span, leaving them in place.
+ *
+ * @param ring A pointer to the magic ring buffer.
+ * @param available A pointer that will be set to the number of readable bytes.
+ * @return A pointer to the first readable byte.
+ */
+unsigned char *peek(MagicRingBuffer *ring, size_t *available) {
+  *available = ring->length;
+  return ring->buffer + ring->readPos;
+}
+
+/**
+ * Discards bytes from the read end of a magic ring buffer, typically once they
+ * have been processed in place through `peek`.
+ *
+ * @param ring A pointer to the magic ring buffer.
+ * @param count The number of bytes to discard.
+ * @return `0` if the bytes were successfully discarded, `1` if the ring buffer
+ *   holds fewer than `count` bytes.
+ */
+int consume(MagicRingBuffer *ring, size_t count) {
+  if (count > ring->length) {
+    printf("Consume error: ring buffer holds fewer bytes than requested.\n");
+    return 1;
+  }
+
+  ring->readPos = (ring->readPos + count) % ring->size;
+  ring->length -= count;
+  return 0;
+}
+
+/**
+ * Copies bytes onto the end of a magic ring buffer if there is room for all of
+ * them.
+ *
+ * @param ring A pointer to the magic ring buffer.
+ * @param data A pointer to the bytes to add.
+ * @param count The number of bytes to add.
+ * @return `0` if the bytes were successfully added, `1` if the ring buffer
+ *   didn't have enough free space.
+ */
+int enqueue(MagicRingBuffer *ring, const void *data, size_t count) {
+  unsigned char *slots = reserve(ring, count);
+  if (!slots) {
+    printf("Enqueue error: ring buffer doesn't have enough free space.\n");
+    return 1;
+  }
+
+  memcpy(slots, data, count);
+  return commit(ring, count);
+}
+
+/**
+ * Removes bytes from the front of a magic ring buffer and copies them into a
+ * caller-supplied buffer, if the ring buffer holds enough of them.
+ *
+ * @param ring A pointer to the magic ring buffer.
+ * @param out A pointer to the buffer that will receive the bytes.
+ * @param count The number of bytes to remove.
+ * @return `0` if the bytes were successfully removed, `1` if the ring buffer
+ *   held fewer than `count` bytes.
+ */
+int dequeue(MagicRingBuffer *ring, void *out, size_t count) {
+  if (count > ring->length) {
+    printf("Dequeue error: ring buffer holds fewer bytes than requested.\n");
+    return 1;
+  }
+
+  memcpy(out, ring->buffer + ring->readPos, count);
+  return consume(ring, count);
+}
+
+/** Clears the contents of a magic ring buffer. */
+void clear(MagicRingBuffer *ring) {
+  ring->readPos = 0;
+  ring->length = 0;
+}
+
+/** Unmaps the buffer of a magic ring buffer and frees its allocated memory. */
+void destroy(MagicRingBuffer *ring) {
+  munmap(ring->buffer, 2 * ring->size);
+  free(ring);
+}
+
+int main() {
+  assert(newMagicRingBuffer(0) == NULL);
+
+  MagicRingBuffer *r = newMagicRingBuffer(100);
+  size_t pageSize = sysconf(_SC_PAGESIZE);
+
+  assert(r->size == pageSize);
+  assert(isEmpty(r));
+  assert(reserve(r, r->size + 1) == NULL);
+
+  // Both halves of the mapping alias the same memory
+  r->buffer[0] = 'x';
+  assert(r->buffer[r->size] == 'x');
+
+  // Move the read position close to the end of the buffer
+  size_t offset = r->size - 3;
+  assert(reserve(r, offset) != NULL);
+  assert(commit(r, offset) == 0);
+  assert(consume(r, offset) == 0);
+  assert(isEmpty(r));
+
+  // A record written across the wrap point reads back as one span
+  const char record[] = "wraparound";
+  assert(enqueue(r, record, sizeof(record)) == 0);
+  size_t available;
+  char *span = (char *)peek(r, &available);
+  assert(available == sizeof(record));
+  assert(strcmp(span, "wraparound") == 0);
+  assert(r->buffer[0] == 'p');
+
+  char out[sizeof(record)];
+  assert(dequeue(r, out, sizeof(record)) == 0);
+  assert(strcmp(out, "wraparound") == 0);
+  assert(dequeue(r, out, 1) == 1);
+  assert(consume(r, 1) == 1);
+
+  unsigned char *slots = reserve(r, r->size);
+  assert(slots != NULL);
+  memset(slots, 'y', r->size);
+  assert(commit(r, r->size) == 0);
+  assert(isFull(r));
+  assert(commit(r, 1) == 1);
+  assert(enqueue(r, "z", 1) == 1);
+
+  clear(r);
+  assert(isEmpty(r));
+
+  destroy(r);
+  printf("All tests passed successfully.\n");
+
+  return 0;
+}
@@ -0,0 +1,243 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct Reader {
+  bool active;
+  long long position; // Sequence number of the next element to read
+  long long missed;   // Elements overwritten before this reader got to them
+} Reader;
+
+/**
+ * A circular queue with a single producer and any number of independent
+ * readers. Every reader keeps its own read cursor and sees every element, so
+ * one buffer can fan out to several consumers without copying data.
+ *
+ * Positions are sequence numbers that only ever increase: the element with
+ * sequence number `s` lives at `array[s % size]`. Without overwrite mode, the
+ * queue is full once the slowest reader is `size` elements behind the writer.
+ * In overwrite mode the writer never waits, and a reader that falls more than
+ * `size` elements behind skips ahead to the oldest element still held.
+ */
+typedef struct MulticastCircularQueue {
+  int size;
+  bool overwrite;
+  long long written; // Total number of elements ever added
+  int maxReaders;
+  Reader *readers;
+  int array[];
+} MulticastCircularQueue;
+
+/**
+ * Constructs a new instance of a multicast circular queue and returns a pointer
+ * to it. (Make sure to `destroy` the queue once you're finished with it.)
+ *
+ * @param bufferSize The number of elements the buffer can hold.
+ * @param maxReaders The maximum number of readers that can be attached at once.
+ * @param overwrite Whether the writer should overwrite elements that some
+ *   reader hasn't read yet rather than reporting the queue as full.
+ */
+MulticastCircularQueue *newMulticastCircularQueue(int bufferSize,
+                                                  int maxReaders,
+                                                  bool overwrite) {
+  if (bufferSize < 1 || maxReaders < 1) {
+    printf("Error: buffer size and maximum readers must be positive.\n");
+    return NULL;
+  }
+
+  MulticastCircularQueue *ptr =
+      malloc(sizeof(MulticastCircularQueue) + bufferSize * sizeof(int));
+
+  ptr->size = bufferSize;
+  ptr->overwrite = overwrite;
+  ptr->written = 0;
+  ptr->maxReaders = maxReaders;
+  ptr->readers = calloc(maxReaders, sizeof(Reader));
+
+  return ptr;
+}
+
+/**
+ * Attaches a new reader to a multicast circular queue. The reader will see
+ * every element added from now on.
+ *
+ * @param queue A pointer to the multicast circular queue.
+ * @return The reader's ID, or `-1` if the maximum number of readers is already
+ *   attached.
+ */
+int addReader(MulticastCircularQueue *queue) {
+  for (int i = 0; i < queue->maxReaders; i++) {
+    if (!queue->readers[i].active) {
+      queue->readers[i] = (Reader){true, queue->written, 0};
+      return i;
+    }
+  }
+
+  printf("Error: multicast circular queue already has maximum readers.\n");
+  return -1;
+}
+
+/** Detaches a reader from a multicast circular queue. */
+void removeReader(MulticastCircularQueue *queue, int reader) {
+  queue->readers[reader].active = false;
+}
+
+/**
+ * Returns the number of elements a given reader of a multicast circular queue
+ * has yet to read (not counting any it will miss to overwrites).
+ */
+int size(MulticastCircularQueue *queue, int reader) {
+  long long behind = queue->written - queue->readers[reader].position;
+  return behind > queue->size ? queue->size : (int)behind;
+}
+
+/**
+ * Returns whether or not a given reader of a multicast circular queue has read
+ * every element.
+ */
+bool isEmpty(MulticastCircularQueue *queue, int reader) {
+  return size(queue, reader) == 0;
+}
+
+/**
+ * Returns whether or not a multicast circular queue is full, i.e. whether its
+ * slowest reader is a whole buffer behind. (An overwriting queue is never
+ * full.)
+ */
+bool isFull(MulticastCircularQueue *queue) {
+  if (queue->overwrite)
+    return false;
+
+  for (int i = 0; i < queue->maxReaders; i++) {
+    if (queue->readers[i].active &&
+        queue->written - queue->readers[i].position == queue->size)
+      return true;
+  }
+
+  return false;
+}
+
+/**
+ * Adds an element to a multicast circular queue, making it visible to every
+ * attached reader.
+ *
+ * @param queue A pointer to the multicast circular queue.
+ * @param element The element to add.
+ * @return `0` if the element was successfully added, `1` if some reader is a
+ *   whole buffer behind (and the queue is not in overwrite mode).
+ */
+int enqueue(MulticastCircularQueue *queue, int element) {
+  if (isFull(queue)) {
+    printf("Enqueue error: multicast circular queue is already full.\n");
+    return 1;
+  }
+
+  queue->array[queue->written % queue->size] = element;
+  queue->written++;
+
+  return 0;
+}
+
+/**
+ * Reads the next element for a given reader of a multicast circular queue,
+ * advancing only that reader's cursor.
+ *
+ * @param queue A pointer to the multicast circular queue.
+ * @param reader The ID of the reader.
+ * @return A pointer to the element within the queue's buffer (valid until the
+ *   writer wraps around to its slot), or `NULL` if the reader has already read
+ *   every element.
+ */
+int *dequeue(MulticastCircularQueue *queue, int reader) {
+  Reader *r = &queue->readers[reader];
+
+  if (r->position == queue->written)
+    return NULL;
+
+  // Skip anything the writer has already overwritten
+  long long oldest = queue->written - queue->size;
+  if (r->position < oldest) {
+    r->missed += oldest - r->position;
+    r->position = oldest;
+  }
+
+  return &queue->array[r->position++ % queue->size];
+}
+
+/** Frees the allocated memory for a multicast circular queue. */
+void destroy(MulticastCircularQueue *queue) {
+  free(queue->readers);
+  free(queue);
+}
+
+int main() {
+  assert(newMulticastCircularQueue(0, 1, false) == NULL);
+  assert(newMulticastCircularQueue(4, 0, false) == NULL);
+
+  MulticastCircularQueue *q = newMulticastCircularQueue(4, 2, false);
+
+  // With no readers, nothing holds the writer back
+  assert(enqueue(q, 100) == 0);
+
+  int fast = addReader(q);
+  int slow = addReader(q);
+  assert(addReader(q) == -1);
+  assert(isEmpty(q, fast));
+  assert(dequeue(q, fast) == NULL);
+
+  for (int i = 1; i <= 4; i++) {
+    assert(enqueue(q, i) == 0);
+  }
+  assert(isFull(q));
+  assert(enqueue(q, 5) == 1);
+
+  // Every reader sees every element
+  for (int i = 1; i <= 4; i++) {
+    assert(*dequeue(q, fast) == i);
+  }
+  assert(isEmpty(q, fast));
+  assert(size(q, slow) == 4);
+  assert(isFull(q));
+
+  // The slowest reader gates the writer
+  assert(*dequeue(q, slow) == 1);
+  assert(enqueue(q, 5) == 0);
+  assert(*dequeue(q, fast) == 5);
+  for (int i = 2; i <= 5; i++) {
+    assert(*dequeue(q, slow) == i);
+  }
+
+  // A detached reader no longer gates the writer
+  removeReader(q, slow);
+  for (int i = 6; i <= 9; i++) {
+    assert(enqueue(q, i) == 0);
+  }
+  assert(enqueue(q, 10) == 1);
+  assert(addReader(q) == slow);
+
+  destroy(q);
+
+  // In overwrite mode, lagging readers skip ahead
+  q = newMulticastCircularQueue(4, 2, true);
+  int reader = addReader(q);
+  for (int i = 0; i < 10; i++) {
+    assert(enqueue(q, i) == 0);
+  }
+  assert(!isFull(q));
+  assert(size(q, reader) == 4);
+  assert(*dequeue(q, reader) == 6);
+  assert(q->readers[reader].missed == 6);
+  assert(*dequeue(q, reader) == 7);
+
+  int late = addReader(q);
+  assert(isEmpty(q, late));
+  enqueue(q, 10);
+  assert(*dequeue(q, late) == 10);
+  assert(*dequeue(q, reader) == 8);
+
+  destroy(q);
+  printf("All tests passed successfully.\n");
+
+  return 0;
+}
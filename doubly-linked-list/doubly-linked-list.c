@@ -3,6 +3,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+
+#include "../node-pool/node-pool.h"
 
 typedef struct Node {
   char *element;
@@ -10,8 +13,8 @@ typedef struct Node {
   struct Node *next;
 } Node;
 
-static Node *newNode(char *element, Node *prev) {
-  Node *ptr = malloc(sizeof(Node));
+static Node *newNode(NodePool *pool, char *element, Node *prev) {
+  Node *ptr = poolAlloc(pool);
 
   ptr->element = element;
   ptr->prev = prev;
@@ -27,13 +30,57 @@ static Node *newNode(char *element, Node *prev) {
 typedef struct DoublyLinkedList {
   Node *head;
   Node *tail;
+  NodePool *pool; // Where the list's nodes are allocated from
+  bool usesDefaultPool;
 } DoublyLinkedList;
 
-DoublyLinkedList *newDoublyLinkedList() {
+/** The number of nodes the default node pool allocates at a time. */
+#define NODES_PER_SLAB 256
+
+/**
+ * The node pool shared by every list made with `newDoublyLinkedList`, so that
+ * nodes can be spliced between any of them in O(1) time, and the number of
+ * such lists. It is created by the first of them and freed with the last.
+ */
+static NodePool *defaultPool = NULL;
+static int defaultPoolUsers = 0;
+
+/**
+ * Constructs a new doubly-linked list that allocates its nodes from a node
+ * pool shared with other lists, and returns a pointer to it. (Make sure to
+ * `destroy` the list once you're finished with it, before the pool.)
+ */
+DoublyLinkedList *newDoublyLinkedListInPool(NodePool *pool) {
+  if (pool->nodeSize < sizeof(Node)) {
+    printf("Error: node pool's nodes are too small for a doubly-linked "
+           "list.\n");
+    return NULL;
+  }
+
   DoublyLinkedList *ptr = malloc(sizeof(DoublyLinkedList));
 
   ptr->head = NULL;
   ptr->tail = NULL;
+  ptr->pool = pool;
+  ptr->usesDefaultPool = false;
+
+  return ptr;
+}
+
+/**
+ * Constructs a new doubly-linked list that allocates its nodes from the
+ * default node pool, and returns a pointer to it. (Make sure to `destroy` the
+ * list once you're finished with it.) Since the pool is shared by every such
+ * list, they must not be used from several threads at once; give each thread
+ * its own pool with `newDoublyLinkedListInPool` instead.
+ */
+DoublyLinkedList *newDoublyLinkedList() {
+  if (!defaultPool)
+    defaultPool = newNodePool(sizeof(Node), NODES_PER_SLAB);
+  defaultPoolUsers++;
+
+  DoublyLinkedList *ptr = newDoublyLinkedListInPool(defaultPool);
+  ptr->usesDefaultPool = true;
 
   return ptr;
 }
@@ -41,15 +88,21 @@ DoublyLinkedList *newDoublyLinkedList() {
 /** Returns whether or not a doubly-linked-list is empty. */
 bool isEmpty(DoublyLinkedList *list) { return list->head == NULL; }
 
-/** Adds an element to the tail end of a doubly-linked list. */
-void add(DoublyLinkedList *list, char *element) {
+/**
+ * Adds an element to the tail end of a doubly-linked list.
+ *
+ * @return The new element's node, which stays valid until it is removed.
+ */
+Node *add(DoublyLinkedList *list, char *element) {
   if (list->tail) {
-    list->tail->next = newNode(element, list->tail);
+    list->tail->next = newNode(list->pool, element, list->tail);
     list->tail = list->tail->next;
   } else {
-    list->head = newNode(element, NULL);
+    list->head = newNode(list->pool, element, NULL);
     list->tail = list->head;
   }
+
+  return list->tail;
 }
 
 /**
@@ -66,14 +119,20 @@ int removeAll(DoublyLinkedList *list, char *element) {
   int numRemoved = 0;
 
   // Remove as many heads as necessary
-  while (list->head->element == element) {
+  while (list->head && list->head->element == element) {
     Node *removedNode = list->head;
 
     list->head = list->head->next;
-    list->head->prev = NULL;
+    if (list->head)
+      list->head->prev = NULL;
     numRemoved++;
 
-    free(removedNode);
+    poolFree(list->pool, removedNode);
+  }
+
+  if (!list->head) {
+    list->tail = NULL;
+    return numRemoved;
   }
 
   // Remove as many tails as necessary
@@ -84,36 +143,42 @@ int removeAll(DoublyLinkedList *list, char *element) {
     list->tail->next = NULL;
     numRemoved++;
 
-    free(removedNode);
+    poolFree(list->pool, removedNode);
   }
 
   // Iterate through rest of list
   Node *currentNode = list->head->next;
-  while (currentNode->next) {
+  while (currentNode && currentNode->next) {
+    Node *nextNode = currentNode->next;
     if (currentNode->element == element) {
-      Node *removedNode = currentNode;
-
       // Link adjacent nodes
       currentNode->prev->next = currentNode->next;
       currentNode->next->prev = currentNode->prev;
       numRemoved++;
 
-      free(removedNode);
+      poolFree(list->pool, currentNode);
     }
-    currentNode = currentNode->next;
+    currentNode = nextNode;
   }
 
   return numRemoved;
 }
 
-/** Clears the contents of a doubly-linked list */
+/**
+ * Clears the contents of a doubly-linked list. The only list using the default
+ * node pool resets the pool in O(1) time; a list sharing a pool gives its nodes
+ * back one by one.
+ */
 void clear(DoublyLinkedList *list) {
-  // Free allocated memory
-  Node *currentNode = list->head;
-  while (currentNode) {
-    Node *nextNode = currentNode->next;
-    free(currentNode);
-    currentNode = nextNode;
+  if (list->usesDefaultPool && defaultPoolUsers == 1) {
+    poolReset(list->pool);
+  } else {
+    Node *currentNode = list->head;
+    while (currentNode) {
+      Node *nextNode = currentNode->next;
+      poolFree(list->pool, currentNode);
+      currentNode = nextNode;
+    }
   }
 
   list->head = NULL;
@@ -123,6 +188,10 @@ void clear(DoublyLinkedList *list) {
 /** Frees the allocated memory for a doubly-linked list and its contents. */
 void destroy(DoublyLinkedList *list) {
   clear(list);
+  if (list->usesDefaultPool && --defaultPoolUsers == 0) {
+    destroyNodePool(defaultPool);
+    defaultPool = NULL;
+  }
   free(list);
 }
 
@@ -148,6 +217,267 @@ void reverse(DoublyLinkedList *list) {
   list->tail->next = NULL;
 }
 
+/**
+ * Links a detached run of nodes into a doubly-linked list just before a given
+ * node, or at the tail end if `position` is `NULL`.
+ */
+static void linkRange(DoublyLinkedList *list, Node *first, Node *last,
+                      Node *position) {
+  first->prev = position ? position->prev : list->tail;
+  last->next = position;
+  if (first->prev) {
+    first->prev->next = first;
+  } else {
+    list->head = first;
+  }
+  if (position) {
+    position->prev = last;
+  } else {
+    list->tail = last;
+  }
+}
+
+/** Detaches a run of nodes from a doubly-linked list, linking around it. */
+static void unlinkRange(DoublyLinkedList *list, Node *first, Node *last) {
+  if (first->prev) {
+    first->prev->next = last->next;
+  } else {
+    list->head = last->next;
+  }
+  if (last->next) {
+    last->next->prev = first->prev;
+  } else {
+    list->tail = first->prev;
+  }
+}
+
+/**
+ * Adds an element to the head end of a doubly-linked list.
+ *
+ * @return The new element's node, which stays valid until it is removed.
+ */
+Node *prepend(DoublyLinkedList *list, char *element) {
+  Node *node = newNode(list->pool, element, NULL);
+  linkRange(list, node, node, list->head);
+  return node;
+}
+
+/**
+ * Inserts an element just before a given node of a doubly-linked list, in
+ * O(1) time.
+ *
+ * @param list A pointer to the doubly-linked list.
+ * @param position A node of the list.
+ * @param element The element to be inserted.
+ * @return The new element's node, which stays valid until it is removed.
+ */
+Node *insertBefore(DoublyLinkedList *list, Node *position, char *element) {
+  Node *node = newNode(list->pool, element, NULL);
+  linkRange(list, node, node, position);
+  return node;
+}
+
+/**
+ * Inserts an element just after a given node of a doubly-linked list, in O(1)
+ * time.
+ *
+ * @param list A pointer to the doubly-linked list.
+ * @param position A node of the list.
+ * @param element The element to be inserted.
+ * @return The new element's node, which stays valid until it is removed.
+ */
+Node *insertAfter(DoublyLinkedList *list, Node *position, char *element) {
+  Node *node = newNode(list->pool, element, NULL);
+  linkRange(list, node, node, position->next);
+  return node;
+}
+
+/**
+ * Removes a given node from a doubly-linked list in O(1) time, giving it back
+ * to the list's node pool.
+ *
+ * @param list A pointer to the doubly-linked list.
+ * @param node A node of the list, which must not be used afterwards.
+ * @return The removed node's element.
+ */
+char *removeNode(DoublyLinkedList *list, Node *node) {
+  char *element = node->element;
+  unlinkRange(list, node, node);
+  poolFree(list->pool, node);
+
+  return element;
+}
+
+/** Moves a given node to the head end of its doubly-linked list. */
+void moveToFront(DoublyLinkedList *list, Node *node) {
+  if (node == list->head)
+    return;
+
+  unlinkRange(list, node, node);
+  linkRange(list, node, node, list->head);
+}
+
+/** Moves a given node to the tail end of its doubly-linked list. */
+void moveToBack(DoublyLinkedList *list, Node *node) {
+  if (node == list->tail)
+    return;
+
+  unlinkRange(list, node, node);
+  linkRange(list, node, node, NULL);
+}
+
+/**
+ * Moves a run of nodes from one doubly-linked list into another (or elsewhere
+ * in the same list), keeping their order, by relinking them in O(1) time. The
+ * nodes themselves move, so handles to them stay valid. Both lists must share
+ * a node pool, as every list made with `newDoublyLinkedList` does.
+ *
+ * @param list A pointer to the doubly-linked list to move the nodes into.
+ * @param position The node of `list` to insert the nodes before, or `NULL` to
+ *   insert them at the tail end. It must not lie within the run.
+ * @param other A pointer to the doubly-linked list to take the nodes from.
+ * @param first The first node of the run.
+ * @param last The last node of the run, which is `first` or comes after it.
+ * @return The first node of the run in its new place, or `NULL` (moving
+ *   nothing) if the lists don't share a node pool.
+ */
+Node *splice(DoublyLinkedList *list, Node *position, DoublyLinkedList *other,
+             Node *first, Node *last) {
+  if (other->pool != list->pool) {
+    printf("Error: can't splice between lists with different node pools.\n");
+    return NULL;
+  }
+
+  unlinkRange(other, first, last);
+  linkRange(list, first, last, position);
+  return first;
+}
+
+/**
+ * A comparator for elements: returns a negative number if `a` belongs before
+ * `b`, a positive number if `a` belongs after `b`, or `0` if they are equal.
+ * (`strcmp` orders strings alphabetically.)
+ */
+typedef int (*Comparator)(const char *a, const char *b);
+
+/**
+ * Merges two sorted chains of nodes linked by `next` into one. Ties take the
+ * node from the left chain first, which keeps sorting stable.
+ *
+ * @return The first node of the merged chain.
+ */
+static Node *mergeChains(Node *left, Node *right, Comparator compare) {
+  Node start = {.next = NULL};
+  Node *tail = &start;
+  while (left && right) {
+    // Start loading the next nodes while the current ones are compared
+    __builtin_prefetch(left->next);
+    __builtin_prefetch(right->next);
+    if (compare(left->element, right->element) <= 0) {
+      tail->next = left;
+      left = left->next;
+    } else {
+      tail->next = right;
+      right = right->next;
+    }
+    tail = tail->next;
+  }
+
+  tail->next = left ? left : right;
+  return start.next;
+}
+
+/**
+ * Restores the `prev` references and the tail of a doubly-linked list from
+ * its `next` references.
+ */
+static void relinkPrev(DoublyLinkedList *list) {
+  Node *previousNode = NULL;
+  for (Node *node = list->head; node; node = node->next) {
+    node->prev = previousNode;
+    previousNode = node;
+  }
+  list->tail = previousNode;
+}
+
+/**
+ * Sorts a doubly-linked list in place with a bottom-up merge sort, in
+ * O(n log n) time. Nodes are relinked rather than their elements copied, no
+ * memory is allocated, and equal elements keep their relative order.
+ *
+ * @param list A pointer to the doubly-linked list.
+ * @param compare The comparator to order elements by.
+ */
+void sort(DoublyLinkedList *list, Comparator compare) {
+  // Sorted runs pending a merge, where `runs[i]` holds 2^i nodes or is empty.
+  // Taking nodes one at a time and merging equal runs like a binary counter
+  // keeps each merge close to recently touched nodes, rather than sweeping the
+  // whole list once per doubling of the run length
+  Node *runs[32] = {NULL};
+  int maxRun = 0;
+
+  Node *node = list->head;
+  while (node) {
+    Node *carry = node;
+    node = node->next;
+    carry->next = NULL;
+
+    // Earlier nodes are always in the left run, so ties stay in order
+    int i = 0;
+    for (; runs[i]; i++) {
+      carry = mergeChains(runs[i], carry, compare);
+      runs[i] = NULL;
+    }
+    runs[i] = carry;
+    if (i > maxRun)
+      maxRun = i;
+  }
+
+  // Merge what's left, from the newest run to the oldest
+  Node *sorted = NULL;
+  for (int i = 0; i <= maxRun; i++) {
+    if (runs[i])
+      sorted = sorted ? mergeChains(runs[i], sorted, compare) : runs[i];
+  }
+
+  list->head = sorted;
+  relinkPrev(list);
+}
+
+/**
+ * Merges another sorted doubly-linked list into a sorted doubly-linked list
+ * in O(n + m) time, leaving the other list empty. Nodes are relinked rather
+ * than copied when both lists share a node pool; otherwise they are moved into
+ * the first list's pool. On ties, elements of the first list come first.
+ * Merging a list into itself does nothing.
+ *
+ * @param list A pointer to the doubly-linked list to merge into.
+ * @param other A pointer to the doubly-linked list to merge from.
+ * @param compare The comparator both lists are sorted by.
+ */
+void mergeSorted(DoublyLinkedList *list, DoublyLinkedList *other,
+                 Comparator compare) {
+  if (other == list || isEmpty(other))
+    return;
+
+  if (other->pool != list->pool) {
+    // Copy the other list's nodes into this list's pool
+    DoublyLinkedList *moved = newDoublyLinkedListInPool(list->pool);
+    for (Node *node = other->head; node; node = node->next) {
+      add(moved, node->element);
+    }
+    clear(other);
+    other->head = moved->head;
+    other->tail = moved->tail;
+    free(moved);
+  }
+
+  list->head = mergeChains(list->head, other->head, compare);
+  other->head = NULL;
+  other->tail = NULL;
+  relinkPrev(list);
+}
+
 /**
  * Prints the contents of a doubly-linked list to the console, head to tail,
  * separated by commas.
@@ -164,7 +494,90 @@ void print(DoublyLinkedList *list) {
   printf("\n");
 }
 
-int main() {
+/** Compares two strings by their first character only. */
+static int compareFirst(const char *a, const char *b) { return *a - *b; }
+
+static int compareStrings(const void *a, const void *b) {
+  return strcmp(*(char **)a, *(char **)b);
+}
+
+/**
+ * Checks that a list holds exactly the given elements in order, and that its
+ * tail is its last node.
+ */
+static bool holds(DoublyLinkedList *list, char **elements, int count) {
+  Node *node = list->head;
+  for (int i = 0; i < count; i++, node = node->next) {
+    if (!node || node->element != elements[i])
+      return false;
+  }
+  if (node)
+    return false;
+
+  // Every node links back to the one before it
+  Node *previousNode = NULL;
+  for (Node *node = list->head; node; node = node->next) {
+    if (node->prev != previousNode)
+      return false;
+    previousNode = node;
+  }
+
+  return count == 0 ? list->tail == NULL : list->tail->next == NULL &&
+                                               list->tail->element ==
+                                                   elements[count - 1];
+}
+
+static double secondsSince(struct timespec *start) {
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * Sorts a list of `n` random strings in place, then by copying its elements
+ * out into an array, sorting that and rebuilding the list.
+ */
+static void benchmark(int n) {
+  char (*strings)[12] = malloc(n * sizeof(*strings));
+  srand(42);
+  for (int i = 0; i < n; i++) {
+    snprintf(strings[i], sizeof(strings[i]), "%07d", rand() % 10000000);
+  }
+
+  struct timespec start;
+  DoublyLinkedList *list = newDoublyLinkedList();
+  for (int i = 0; i < n; i++) {
+    add(list, strings[i]);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  sort(list, strcmp);
+  printf("in-place merge sort: %.3fs\n", secondsSince(&start));
+  destroy(list);
+
+  list = newDoublyLinkedList();
+  for (int i = 0; i < n; i++) {
+    add(list, strings[i]);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  char **elements = malloc(n * sizeof(char *));
+  int count = 0;
+  for (Node *node = list->head; node; node = node->next) {
+    elements[count++] = node->element;
+  }
+  qsort(elements, count, sizeof(char *), compareStrings);
+  destroy(list);
+  list = newDoublyLinkedList();
+  for (int i = 0; i < count; i++) {
+    add(list, elements[i]);
+  }
+  printf("copy out, sort and rebuild: %.3fs\n", secondsSince(&start));
+
+  free(elements);
+  destroy(list);
+  free(strings);
+}
+
+int main(int argc, char *argv[]) {
   DoublyLinkedList *l = newDoublyLinkedList();
 
   print(l);
@@ -197,8 +610,187 @@ int main() {
   assert(isEmpty(l));
   assert(l->tail == NULL);
 
+  // Clearing reuses the pool's nodes from the start, in order
+  add(l, "a");
+  Node *first = l->head;
+  add(l, "b");
+  assert((char *)l->tail == (char *)first + l->pool->nodeSize);
+  assert(removeAll(l, "a") == 1);
+  assert(removeAll(l, "b") == 1);
+  assert(isEmpty(l) && l->tail == NULL);
+  clear(l);
+  add(l, "c");
+  assert(l->head == first);
+
   destroy(l);
+
+  // Lists sharing a pool reuse each other's freed nodes
+  NodePool *pool = newNodePool(sizeof(Node), 4);
+  DoublyLinkedList *a = newDoublyLinkedListInPool(pool);
+  DoublyLinkedList *b = newDoublyLinkedListInPool(pool);
+  for (int i = 0; i < 10; i++) {
+    add(a, i == 4 ? "x" : "y");
+    add(b, "b");
+  }
+  Node *reused = a->head->next->next->next->next;
+  assert(removeAll(a, "x") == 1);
+  add(b, "b");
+  assert(b->tail == reused);
+  destroy(a);
+  destroy(b);
+  destroyNodePool(pool);
+
+  // Sorting relinks nodes into order, keeping equal elements in order
+  DoublyLinkedList *l2 = newDoublyLinkedList();
+  sort(l2, strcmp);
+  assert(isEmpty(l2) && l2->tail == NULL);
+  char strings[500][8];
+  char *expected[500];
+  for (int i = 0; i < 500; i++) {
+    snprintf(strings[i], sizeof(strings[i]), "%d", rand() % 1000);
+    add(l2, strings[i]);
+    expected[i] = strings[i];
+  }
+  sort(l2, strcmp);
+  qsort(expected, 500, sizeof(char *), compareStrings);
+  for (Node *node = l2->head; node->next; node = node->next) {
+    assert(strcmp(node->element, node->next->element) <= 0);
+  }
+  Node *node = l2->head;
+  for (int i = 0; i < 500; i++, node = node->next) {
+    assert(strcmp(node->element, expected[i]) == 0);
+  }
+
+  char *ties[] = {"b1", "a1", "b2", "c1", "a2", "b3"};
+  char *stable[] = {"a1", "a2", "b1", "b2", "b3", "c1"};
+  clear(l2);
+  for (int i = 0; i < 6; i++) {
+    add(l2, ties[i]);
+  }
+  sort(l2, compareFirst);
+  assert(holds(l2, stable, 6));
+  add(l2, "d1");
+  assert(strcmp(l2->tail->element, "d1") == 0);
+
+  // Merging sorted lists, whether or not they share a node pool
+  char *left[] = {"a1", "b1", "b2", "d1"};
+  char *right[] = {"a2", "b3", "c1", "e1"};
+  char *merged[] = {"a1", "a2", "b1", "b2", "b3", "c1", "d1", "e1"};
+  NodePool *shared = newNodePool(sizeof(Node), 4);
+  DoublyLinkedList *lists[][2] = {
+      {newDoublyLinkedList(), newDoublyLinkedListInPool(shared)},
+      {newDoublyLinkedListInPool(shared), newDoublyLinkedListInPool(shared)}};
+  for (int i = 0; i < 2; i++) {
+    DoublyLinkedList *a = lists[i][0];
+    DoublyLinkedList *b = lists[i][1];
+    for (int j = 0; j < 4; j++) {
+      add(a, left[j]);
+      add(b, right[j]);
+    }
+    mergeSorted(a, b, compareFirst);
+    assert(holds(a, merged, 8));
+    assert(isEmpty(b) && b->tail == NULL);
+
+    mergeSorted(b, a, compareFirst);
+    assert(holds(b, merged, 8));
+    mergeSorted(b, a, compareFirst);
+    assert(holds(b, merged, 8));
+    mergeSorted(b, b, compareFirst);
+    assert(holds(b, merged, 8));
+    destroy(a);
+    destroy(b);
+  }
+  destroyNodePool(shared);
+  destroy(l2);
+
+  // Inserting, moving and removing through node handles
+  DoublyLinkedList *l3 = newDoublyLinkedList();
+  Node *hey = add(l3, "hey");
+  Node *unicorn = prepend(l3, "unicorn");
+  Node *squirrel = insertAfter(l3, hey, "squirrel");
+  Node *opera = insertBefore(l3, hey, "opera");
+  Node *boring = insertBefore(l3, unicorn, "boring");
+  assert(holds(l3, (char *[]){"boring", "unicorn", "opera", "hey", "squirrel"},
+               5));
+
+  moveToFront(l3, squirrel);
+  moveToBack(l3, boring);
+  moveToFront(l3, squirrel);
+  moveToBack(l3, boring);
+  assert(holds(l3, (char *[]){"squirrel", "unicorn", "opera", "hey", "boring"},
+               5));
+
+  assert(strcmp(removeNode(l3, squirrel), "squirrel") == 0);
+  assert(strcmp(removeNode(l3, boring), "boring") == 0);
+  assert(strcmp(removeNode(l3, opera), "opera") == 0);
+  assert(holds(l3, (char *[]){"unicorn", "hey"}, 2));
+  removeNode(l3, unicorn);
+  removeNode(l3, hey);
+  assert(holds(l3, NULL, 0));
+  Node *only = insertAfter(l3, add(l3, "a"), "b");
+  moveToFront(l3, only);
+  assert(holds(l3, (char *[]){"b", "a"}, 2));
+  destroy(l3);
+
+  // Splicing runs of nodes between lists sharing a pool, and within a list
+  NodePool *spliced = newNodePool(sizeof(Node), 4);
+  DoublyLinkedList *from = newDoublyLinkedListInPool(spliced);
+  DoublyLinkedList *to = newDoublyLinkedListInPool(spliced);
+  Node *n[6];
+  char *labels[] = {"0", "1", "2", "3", "4", "5"};
+  for (int i = 0; i < 6; i++) {
+    n[i] = add(from, labels[i]);
+  }
+  add(to, "x");
+  Node *y = add(to, "y");
+
+  assert(splice(to, y, from, n[1], n[3]) == n[1]);
+  assert(holds(from, (char *[]){"0", "4", "5"}, 3));
+  assert(holds(to, (char *[]){"x", "1", "2", "3", "y"}, 5));
+  assert(splice(to, NULL, from, n[0], n[0]) == n[0]);
+  assert(splice(to, to->head, from, n[4], n[5]) == n[4]);
+  assert(isEmpty(from) && from->tail == NULL);
+  assert(holds(to, (char *[]){"4", "5", "x", "1", "2", "3", "y", "0"}, 8));
+
+  assert(splice(to, n[4], to, n[1], n[3]) == n[1]);
+  assert(splice(to, NULL, to, n[4], n[5]) == n[4]);
+  assert(holds(to, (char *[]){"1", "2", "3", "x", "y", "0", "4", "5"}, 8));
+
+  // Lists in different pools can't be spliced between
+  DoublyLinkedList *own = newDoublyLinkedList();
+  Node *z = add(own, "z");
+  assert(splice(own, z, to, n[2], y) == NULL);
+  assert(holds(own, (char *[]){"z"}, 1));
+  assert(holds(to, (char *[]){"1", "2", "3", "x", "y", "0", "4", "5"}, 8));
+
+  // Lists made with `newDoublyLinkedList` share the default pool, so nodes
+  // move between them and their handles stay valid
+  DoublyLinkedList *other = newDoublyLinkedList();
+  Node *w = add(other, "w");
+  add(other, "v");
+  assert(splice(own, z, other, w, w) == w);
+  assert(holds(own, (char *[]){"w", "z"}, 2));
+  assert(holds(other, (char *[]){"v"}, 1));
+  assert(splice(other, NULL, own, own->head, own->tail) == w);
+  assert(isEmpty(own) && own->tail == NULL);
+  assert(holds(other, (char *[]){"v", "w", "z"}, 3));
+
+  // Clearing one list leaves the others sharing the default pool alone
+  add(own, "u");
+  clear(own);
+  add(own, "t");
+  assert(holds(other, (char *[]){"v", "w", "z"}, 3));
+  assert(holds(own, (char *[]){"t"}, 1));
+  destroy(other);
+  destroy(own);
+  destroy(from);
+  destroy(to);
+  destroyNodePool(spliced);
   printf("All tests passed successfully.\n");
 
+  // Pass `bench [number of elements]` to compare against sorting a copy
+  if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    benchmark(argc > 2 ? atoi(argv[2]) : 1000000);
+
   return 0;
 }
@@ -0,0 +1,420 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * Returns a pointer to the struct of a given type that contains a given link
+ * as the given member.
+ */
+#define CONTAINER_OF(link, type, member)                                       \
+  ((type *)((char *)(link) - offsetof(type, member)))
+
+/**
+ * The link fields of an intrusive doubly-linked list, to be embedded in the
+ * struct of each object that goes on the list. An object with several links
+ * can be on several lists at once.
+ *
+ * A link that isn't on a list points to itself, so it must be set up with
+ * `initLink` before its first use.
+ */
+typedef struct Link {
+  struct Link *prev;
+  struct Link *next;
+} Link;
+
+/** Sets up a link that isn't on any list. */
+void initLink(Link *link) {
+  link->prev = link;
+  link->next = link;
+}
+
+/** Returns whether or not a link is on a list. */
+bool isLinked(Link *link) { return link->next != link; }
+
+/**
+ * An intrusive doubly-linked list, whose nodes are links embedded in the
+ * objects on the list rather than nodes it allocates itself, so adding or
+ * moving an object never allocates and reaching it from a node takes no extra
+ * pointer hop. The list is circular around a sentinel link, which lets a link
+ * be unlinked in O(1) time without knowing which list it is on.
+ *
+ * The list doesn't own its objects: destroying it only unlinks them.
+ */
+typedef struct IntrusiveDoublyLinkedList {
+  Link sentinel; // Before the head and after the tail
+} IntrusiveDoublyLinkedList;
+
+/**
+ * Constructs a new intrusive doubly-linked list and returns a pointer to it.
+ * (Make sure to `destroy` the list once you're finished with it.)
+ */
+IntrusiveDoublyLinkedList *newIntrusiveDoublyLinkedList() {
+  IntrusiveDoublyLinkedList *ptr = malloc(sizeof(IntrusiveDoublyLinkedList));
+
+  initLink(&ptr->sentinel);
+
+  return ptr;
+}
+
+/** Returns whether or not an intrusive doubly-linked list is empty. */
+bool isEmpty(IntrusiveDoublyLinkedList *list) {
+  return !isLinked(&list->sentinel);
+}
+
+/**
+ * Returns the number of objects in an intrusive doubly-linked list, in O(n)
+ * time.
+ */
+int size(IntrusiveDoublyLinkedList *list) {
+  int length = 0;
+  for (Link *link = list->sentinel.next; link != &list->sentinel;
+       link = link->next) {
+    length++;
+  }
+
+  return length;
+}
+
+/** Links a link in between two adjacent links. */
+static void linkBetween(Link *link, Link *prev, Link *next) {
+  link->prev = prev;
+  link->next = next;
+  prev->next = link;
+  next->prev = link;
+}
+
+/**
+ * Removes a link from whichever list it is on (if any), in O(1) time.
+ *
+ * @return `0` if the link was removed, `1` if it wasn't on a list.
+ */
+int removeLink(Link *link) {
+  if (!isLinked(link))
+    return 1;
+
+  link->prev->next = link->next;
+  link->next->prev = link->prev;
+  initLink(link);
+  return 0;
+}
+
+/**
+ * Adds a link to the tail end of an intrusive doubly-linked list, first
+ * removing it from any list it is already on.
+ */
+void add(IntrusiveDoublyLinkedList *list, Link *link) {
+  removeLink(link);
+  linkBetween(link, list->sentinel.prev, &list->sentinel);
+}
+
+/**
+ * Adds a link to the head end of an intrusive doubly-linked list, first
+ * removing it from any list it is already on.
+ */
+void prepend(IntrusiveDoublyLinkedList *list, Link *link) {
+  removeLink(link);
+  linkBetween(link, &list->sentinel, list->sentinel.next);
+}
+
+/**
+ * Inserts a link just before another link that is already on a list, first
+ * removing it from any list it is already on. Inserting a link before itself
+ * does nothing.
+ */
+void insertBefore(Link *position, Link *link) {
+  if (position == link)
+    return;
+
+  removeLink(link);
+  linkBetween(link, position->prev, position);
+}
+
+/**
+ * Returns the link at the head of an intrusive doubly-linked list, or `NULL`
+ * if the list is empty.
+ */
+Link *first(IntrusiveDoublyLinkedList *list) {
+  return isEmpty(list) ? NULL : list->sentinel.next;
+}
+
+/**
+ * Returns the link at the tail of an intrusive doubly-linked list, or `NULL`
+ * if the list is empty.
+ */
+Link *last(IntrusiveDoublyLinkedList *list) {
+  return isEmpty(list) ? NULL : list->sentinel.prev;
+}
+
+/**
+ * Returns the link after a given link on an intrusive doubly-linked list, or
+ * `NULL` if it is the tail.
+ */
+Link *nextLink(IntrusiveDoublyLinkedList *list, Link *link) {
+  return link->next == &list->sentinel ? NULL : link->next;
+}
+
+/**
+ * Returns the link before a given link on an intrusive doubly-linked list, or
+ * `NULL` if it is the head.
+ */
+Link *prevLink(IntrusiveDoublyLinkedList *list, Link *link) {
+  return link->prev == &list->sentinel ? NULL : link->prev;
+}
+
+/**
+ * Removes the link at the head of an intrusive doubly-linked list.
+ *
+ * @return The removed link, or `NULL` if the list is empty.
+ */
+Link *removeFirst(IntrusiveDoublyLinkedList *list) {
+  Link *link = first(list);
+  if (link)
+    removeLink(link);
+
+  return link;
+}
+
+/**
+ * Moves every link of another intrusive doubly-linked list onto the tail end of
+ * a list in O(1) time, leaving the other list empty. Concatenating a list
+ * onto itself does nothing.
+ */
+void concat(IntrusiveDoublyLinkedList *list, IntrusiveDoublyLinkedList *other) {
+  if (other == list || isEmpty(other))
+    return;
+
+  Link *head = other->sentinel.next, *tail = other->sentinel.prev;
+  initLink(&other->sentinel);
+
+  head->prev = list->sentinel.prev;
+  list->sentinel.prev->next = head;
+  tail->next = &list->sentinel;
+  list->sentinel.prev = tail;
+}
+
+/** Removes every link from an intrusive doubly-linked list. */
+void clear(IntrusiveDoublyLinkedList *list) {
+  while (removeFirst(list)) {
+  }
+}
+
+/**
+ * Frees the allocated memory for an intrusive doubly-linked list, first
+ * removing its links. The objects themselves are left alone.
+ */
+void destroy(IntrusiveDoublyLinkedList *list) {
+  clear(list);
+  free(list);
+}
+
+/** An object that sits on two lists at once through its two links. */
+typedef struct Connection {
+  char *name;
+  Link byState; // On the list for the connection's state
+  Link byAge;   // On the list of every connection, oldest first
+} Connection;
+
+/**
+ * Prints the names of the connections on a list of `byState` links to the
+ * console, head to tail, separated by commas.
+ */
+static void print(IntrusiveDoublyLinkedList *list) {
+  for (Link *link = first(list); link; link = nextLink(list, link)) {
+    printf(link == first(list) ? "\"%s\"" : ", \"%s\"",
+           CONTAINER_OF(link, Connection, byState)->name);
+  }
+  printf("\n");
+}
+
+/**
+ * Checks that a list holds exactly the given connections in order, through
+ * the given member, walking it both forwards and backwards.
+ */
+static bool holds(IntrusiveDoublyLinkedList *list, Connection **connections,
+                  int count, size_t member) {
+  Link *link = first(list);
+  for (int i = 0; i < count; i++, link = nextLink(list, link)) {
+    if (!link || (char *)link - member != (char *)connections[i])
+      return false;
+  }
+  if (link)
+    return false;
+
+  link = last(list);
+  for (int i = count - 1; i >= 0; i--, link = prevLink(list, link)) {
+    if (!link || (char *)link - member != (char *)connections[i])
+      return false;
+  }
+
+  return !link && size(list) == count;
+}
+
+static double secondsSince(struct timespec *start) {
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/** A separately allocated node wrapping an object, for comparison. */
+typedef struct WrapperNode {
+  Connection *connection;
+  struct WrapperNode *prev;
+  struct WrapperNode *next;
+} WrapperNode;
+
+/**
+ * Moves `n` connections back and forth between two lists `rounds` times, once
+ * through their embedded links and once by freeing and allocating a node
+ * wrapping the connection on every move, as a non-intrusive list would.
+ */
+static void benchmark(int n, int rounds) {
+  Connection *connections = malloc(n * sizeof(Connection));
+  for (int i = 0; i < n; i++) {
+    initLink(&connections[i].byState);
+  }
+  IntrusiveDoublyLinkedList *lists[2] = {newIntrusiveDoublyLinkedList(),
+                                         newIntrusiveDoublyLinkedList()};
+  for (int i = 0; i < n; i++) {
+    add(lists[0], &connections[i].byState);
+  }
+
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int r = 0; r < rounds; r++) {
+    Link *link;
+    while ((link = removeFirst(lists[r % 2]))) {
+      add(lists[(r + 1) % 2], link);
+    }
+  }
+  printf("intrusive moves: %.3fs\n", secondsSince(&start));
+
+  // Each list is a sentinel wrapper node, as above
+  WrapperNode sentinels[2];
+  for (int i = 0; i < 2; i++) {
+    sentinels[i].prev = sentinels[i].next = &sentinels[i];
+  }
+  for (int i = 0; i < n; i++) {
+    WrapperNode *node = malloc(sizeof(WrapperNode));
+    node->connection = &connections[i];
+    node->prev = sentinels[0].prev;
+    node->next = &sentinels[0];
+    sentinels[0].prev->next = node;
+    sentinels[0].prev = node;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int r = 0; r < rounds; r++) {
+    WrapperNode *from = &sentinels[r % 2], *to = &sentinels[(r + 1) % 2];
+    while (from->next != from) {
+      WrapperNode *node = from->next;
+      Connection *connection = node->connection;
+      from->next = node->next;
+      node->next->prev = from;
+      free(node);
+
+      node = malloc(sizeof(WrapperNode));
+      node->connection = connection;
+      node->prev = to->prev;
+      node->next = to;
+      to->prev->next = node;
+      to->prev = node;
+    }
+  }
+  printf("allocating moves: %.3fs\n", secondsSince(&start));
+
+  WrapperNode *sentinel = &sentinels[rounds % 2];
+  while (sentinel->next != sentinel) {
+    WrapperNode *node = sentinel->next;
+    sentinel->next = node->next;
+    free(node);
+  }
+  destroy(lists[0]);
+  destroy(lists[1]);
+  free(connections);
+}
+
+int main(int argc, char *argv[]) {
+  char *names[] = {"hey", "unicorn", "squirrel", "opera", "boring"};
+  Connection connections[5];
+  Connection *c[5];
+  for (int i = 0; i < 5; i++) {
+    c[i] = &connections[i];
+    c[i]->name = names[i];
+    initLink(&c[i]->byState);
+    initLink(&c[i]->byAge);
+  }
+  size_t byState = offsetof(Connection, byState);
+  size_t byAge = offsetof(Connection, byAge);
+
+  IntrusiveDoublyLinkedList *open = newIntrusiveDoublyLinkedList();
+  IntrusiveDoublyLinkedList *idle = newIntrusiveDoublyLinkedList();
+  IntrusiveDoublyLinkedList *all = newIntrusiveDoublyLinkedList();
+
+  print(open);
+  assert(isEmpty(open));
+  assert(first(open) == NULL && last(open) == NULL);
+  assert(removeFirst(open) == NULL);
+
+  // Every connection is on `all`, and on one of `open` or `idle`
+  for (int i = 0; i < 5; i++) {
+    add(all, &c[i]->byAge);
+    add(i % 2 == 0 ? open : idle, &c[i]->byState);
+  }
+  print(open);
+  assert(CONTAINER_OF(first(open), Connection, byState) == c[0]);
+  assert(holds(open, (Connection *[]){c[0], c[2], c[4]}, 3, byState));
+  assert(holds(idle, (Connection *[]){c[1], c[3]}, 2, byState));
+  assert(holds(all, c, 5, byAge));
+
+  // Adding a link to another list moves it there
+  add(idle, &c[2]->byState);
+  prepend(open, &c[3]->byState);
+  assert(holds(open, (Connection *[]){c[3], c[0], c[4]}, 3, byState));
+  assert(holds(idle, (Connection *[]){c[1], c[2]}, 2, byState));
+  assert(holds(all, c, 5, byAge));
+
+  insertBefore(&c[1]->byState, &c[4]->byState);
+  assert(holds(open, (Connection *[]){c[3], c[0]}, 2, byState));
+  assert(holds(idle, (Connection *[]){c[4], c[1], c[2]}, 3, byState));
+
+  // Removing a link only takes it off its own list
+  assert(removeLink(&c[0]->byState) == 0);
+  assert(removeLink(&c[0]->byState) == 1);
+  assert(!isLinked(&c[0]->byState) && isLinked(&c[0]->byAge));
+  assert(holds(open, (Connection *[]){c[3]}, 1, byState));
+  assert(holds(all, c, 5, byAge));
+
+  assert(removeFirst(idle) == &c[4]->byState);
+  assert(holds(idle, (Connection *[]){c[1], c[2]}, 2, byState));
+
+  concat(open, idle);
+  assert(isEmpty(idle));
+  assert(holds(open, (Connection *[]){c[3], c[1], c[2]}, 3, byState));
+  concat(open, idle);
+  concat(idle, open);
+  assert(holds(idle, (Connection *[]){c[3], c[1], c[2]}, 3, byState));
+  concat(idle, idle);
+  insertBefore(&c[1]->byState, &c[1]->byState);
+  assert(holds(idle, (Connection *[]){c[3], c[1], c[2]}, 3, byState));
+
+  destroy(idle);
+  assert(!isLinked(&c[1]->byState) && isLinked(&c[1]->byAge));
+  clear(all);
+  assert(isEmpty(all) && !isLinked(&c[1]->byAge));
+
+  destroy(open);
+  destroy(all);
+  printf("All tests passed successfully.\n");
+
+  // Pass `bench [number of connections] [rounds]` to compare against
+  // allocating a node per move
+  if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    benchmark(argc > 2 ? atoi(argv[2]) : 100000,
+              argc > 3 ? atoi(argv[3]) : 100);
+
+  return 0;
+}
@@ -0,0 +1,92 @@
+#include <assert.h>
+#include <limits.h>
+
+#include "generic-heap.h"
+
+#define LESS_THAN(a, b) ((a) < (b))
+#define GREATER_THAN(a, b) ((a) > (b))
+
+DEFINE_HEAP(IntMinHeap, int, LESS_THAN)
+DEFINE_HEAP(IntMaxHeap, int, GREATER_THAN)
+
+/** A struct payload stored inline in the heap, so no parallel ID array. */
+typedef struct ScoredId {
+  double score;
+  int id;
+} ScoredId;
+
+/** Orders by highest score, breaking ties by lowest ID. */
+static inline bool ranksAbove(ScoredId a, ScoredId b) {
+  return a.score > b.score || (a.score == b.score && a.id < b.id);
+}
+
+DEFINE_HEAP(RankingHeap, ScoredId, ranksAbove)
+
+int main() {
+  assert(newIntMinHeap(0) == NULL);
+
+  IntMinHeap *minHeap = newIntMinHeap(10);
+  IntMaxHeap *maxHeap = newIntMaxHeap(10);
+  int value;
+
+  assert(IntMinHeapIsEmpty(minHeap));
+  assert(IntMinHeapPeek(minHeap) == NULL);
+  assert(IntMinHeapPop(minHeap, &value) == 1);
+
+  int minValue = INT_MAX;
+  int maxValue = INT_MIN;
+  for (int i = 0; i < 10; i++) {
+    int v = rand() % 100;
+    if (v < minValue)
+      minValue = v;
+    if (v > maxValue)
+      maxValue = v;
+
+    assert(IntMinHeapPush(minHeap, v) == 0);
+    assert(IntMaxHeapPush(maxHeap, v) == 0);
+  }
+  assert(IntMinHeapIsFull(minHeap));
+  assert(IntMinHeapPush(minHeap, 1) == 1);
+  assert(IntMinHeapLength(minHeap) == 10);
+  assert(*IntMinHeapPeek(minHeap) == minValue);
+  assert(*IntMaxHeapPeek(maxHeap) == maxValue);
+
+  // Test popping in order
+  int previous = INT_MIN;
+  while (IntMinHeapPop(minHeap, &value) == 0) {
+    assert(value >= previous);
+    previous = value;
+  }
+  previous = INT_MAX;
+  while (IntMaxHeapPop(maxHeap, &value) == 0) {
+    assert(value <= previous);
+    previous = value;
+  }
+  assert(IntMaxHeapIsEmpty(maxHeap));
+
+  IntMinHeapDestroy(minHeap);
+  IntMaxHeapDestroy(maxHeap);
+
+  // Struct payloads keep their IDs alongside their keys
+  ScoredId scores[] = {{0.5, 3}, {0.9, 7}, {0.1, 1}, {0.9, 2}, {0.7, 5}};
+  RankingHeap *ranking = RankingHeapFromArray(scores, 5, 6);
+  assert(RankingHeapFromArray(scores, 5, 4) == NULL);
+  assert(RankingHeapPush(ranking, (ScoredId){0.8, 4}) == 0);
+
+  int expectedIds[] = {2, 7, 4, 5, 3, 1};
+  ScoredId top;
+  for (int i = 0; i < 6; i++) {
+    assert(RankingHeapPop(ranking, &top) == 0);
+    assert(top.id == expectedIds[i]);
+  }
+  assert(RankingHeapIsEmpty(ranking));
+
+  RankingHeapPush(ranking, (ScoredId){1.0, 9});
+  RankingHeapClear(ranking);
+  assert(RankingHeapLength(ranking) == 0);
+
+  RankingHeapDestroy(ranking);
+  printf("All tests passed successfully.\n");
+
+  return 0;
+}
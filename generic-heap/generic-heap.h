@@ -0,0 +1,286 @@
+#ifndef GENERIC_HEAP_H
+#define GENERIC_HEAP_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** The number of values a new heap has room for before it first grows. */
+#define HEAP_INITIAL_CAPACITY 16
+
+/**
+ * Defines a binary heap type named `Name` holding values of type `Type`, along
+ * with its functions, all specialized at compile time. `comesBefore(a, b)` must
+ * be a macro or function that returns whether value `a` belongs above value `b`
+ * (e.g. `a < b` for a min heap, `a > b` for a max heap); since it is expanded
+ * directly into the generated code, it is inlined rather than called through a
+ * function pointer. Values of any type, including structs, are stored inline.
+ * `MinHeap` and `MaxHeap` are both defined this way.
+ *
+ * Values are stored as an implicit data structure: for a value at index `i`,
+ * its children will be located at `2 * i + 1` and `2 * i + 2`, and its parent
+ * at `(i - 1) / 2`. The array starts small and grows geometrically as values
+ * are added, so `maxSize` only caps the heap's size rather than being
+ * allocated up front.
+ *
+ * For example, `DEFINE_HEAP(IntMinHeap, int, LESS_THAN)` (with
+ * `#define LESS_THAN(a, b) ((a) < (b))`) defines `IntMinHeap`,
+ * `newIntMinHeap`, `IntMinHeapPush`, `IntMinHeapPop` and so on.
+ */
+#define DEFINE_HEAP(Name, Type, comesBefore)                                   \
+  typedef struct Name {                                                        \
+    int maxSize;  /* The most values the heap may ever hold */                 \
+    int capacity; /* The number of values the array has room for */            \
+    int length;                                                                \
+    Type *array;                                                               \
+  } Name;                                                                      \
+                                                                               \
+  /* Constructs a new heap; `Name##Destroy` it once you're finished. */        \
+  static inline Name *new##Name(int maxSize) {                                 \
+    if (maxSize < 1) {                                                         \
+      printf("Error: maximum size must be positive.\n");                       \
+      return NULL;                                                             \
+    }                                                                          \
+                                                                               \
+    Name *ptr = malloc(sizeof(Name));                                          \
+    ptr->maxSize = maxSize;                                                    \
+    ptr->capacity =                                                            \
+        maxSize < HEAP_INITIAL_CAPACITY ? maxSize : HEAP_INITIAL_CAPACITY;     \
+    ptr->length = 0;                                                           \
+    ptr->array = malloc(ptr->capacity * sizeof(Type));                         \
+    return ptr;                                                                \
+  }                                                                            \
+                                                                               \
+  static inline void Name##Destroy(Name *heap) {                               \
+    free(heap->array);                                                         \
+    free(heap);                                                                \
+  }                                                                            \
+                                                                               \
+  static inline int Name##Length(Name *heap) { return heap->length; }          \
+                                                                               \
+  static inline bool Name##IsEmpty(Name *heap) { return heap->length == 0; }   \
+                                                                               \
+  static inline bool Name##IsFull(Name *heap) {                                \
+    return heap->length == heap->maxSize;                                      \
+  }                                                                            \
+                                                                               \
+  static inline void Name##Clear(Name *heap) { heap->length = 0; }             \
+                                                                               \
+  /* Returns a pointer to the top value, or `NULL` if the heap is empty. */    \
+  static inline Type *Name##Peek(Name *heap) {                                 \
+    return heap->length > 0 ? &heap->array[0] : NULL;                          \
+  }                                                                            \
+                                                                               \
+  /* Makes room in the array for at least `capacity` values; returns `0` on */ \
+  /* success, `1` past the maximum size or if memory ran out. */               \
+  static inline int Name##Reserve(Name *heap, int capacity) {                  \
+    if (capacity <= heap->capacity)                                            \
+      return 0;                                                                \
+                                                                               \
+    if (capacity > heap->maxSize) {                                            \
+      printf("Error: capacity can't exceed the heap's maximum size.\n");       \
+      return 1;                                                                \
+    }                                                                          \
+                                                                               \
+    Type *array = realloc(heap->array, (size_t)capacity * sizeof(Type));       \
+    if (!array) {                                                              \
+      printf("Error: out of memory.\n");                                       \
+      return 1;                                                                \
+    }                                                                          \
+                                                                               \
+    heap->array = array;                                                       \
+    heap->capacity = capacity;                                                 \
+    return 0;                                                                  \
+  }                                                                            \
+                                                                               \
+  /* Grows the array to fit `needed` values by doubling its capacity (but */   \
+  /* never past the maximum size), for amortized O(1) reallocation work. */    \
+  static inline int Name##Grow(Name *heap, int needed) {                       \
+    int capacity = heap->capacity;                                             \
+    while (capacity < needed) {                                                \
+      capacity = capacity > heap->maxSize / 2 ? heap->maxSize : capacity * 2;  \
+    }                                                                          \
+                                                                               \
+    return Name##Reserve(heap, capacity);                                      \
+  }                                                                            \
+                                                                               \
+  /* Shrinks the array to fit the values the heap currently holds. */          \
+  static inline void Name##ShrinkToFit(Name *heap) {                           \
+    int capacity = heap->length > 0 ? heap->length : 1;                        \
+    if (capacity == heap->capacity)                                            \
+      return;                                                                  \
+                                                                               \
+    Type *array = realloc(heap->array, capacity * sizeof(Type));               \
+    if (array) {                                                               \
+      heap->array = array;                                                     \
+      heap->capacity = capacity;                                               \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  /* Places a value at an index of a heap-ordered array, then moves it up */   \
+  /* above any parent it comes before. */                                      \
+  static inline void Name##SiftUp(Type *array, int currentIdx, Type value) {   \
+    while (currentIdx > 0) {                                                   \
+      int parentIdx = (currentIdx - 1) / 2;                                    \
+      if (!comesBefore(value, array[parentIdx]))                               \
+        break;                                                                 \
+                                                                               \
+      array[currentIdx] = array[parentIdx];                                    \
+      currentIdx = parentIdx;                                                  \
+    }                                                                          \
+                                                                               \
+    array[currentIdx] = value;                                                 \
+  }                                                                            \
+                                                                               \
+  /* Places a value at an index of a heap-ordered array of `length` values, */ \
+  /* then moves it down below any child that comes before it. */               \
+  static inline void Name##SiftDown(Type *array, int length, int currentIdx,   \
+                                    Type value) {                              \
+    while (2 * currentIdx + 1 < length) {                                      \
+      int childIdx = 2 * currentIdx + 1;                                       \
+      if (childIdx + 1 < length &&                                             \
+          comesBefore(array[childIdx + 1], array[childIdx]))                   \
+        childIdx++;                                                            \
+      if (!comesBefore(array[childIdx], value))                                \
+        break;                                                                 \
+                                                                               \
+      array[currentIdx] = array[childIdx];                                     \
+      currentIdx = childIdx;                                                   \
+    }                                                                          \
+                                                                               \
+    array[currentIdx] = value;                                                 \
+  }                                                                            \
+                                                                               \
+  /* Restores the heap property across the whole array in O(n) time */        \
+  /* (Floyd's method), versus O(n log n) for pushing values one by one. */     \
+  static inline void Name##Heapify(Name *heap) {                               \
+    for (int i = heap->length / 2 - 1; i >= 0; i--) {                          \
+      Name##SiftDown(heap->array, heap->length, i, heap->array[i]);            \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  /* Adds a value; returns `0` on success, `1` if the heap was full. */        \
+  static inline int Name##Push(Name *heap, Type value) {                       \
+    if (Name##IsFull(heap)) {                                                  \
+      printf("Error: stack overflow: heap is already at maximum capacity.\n"); \
+      return 1;                                                                \
+    }                                                                          \
+                                                                               \
+    if (heap->length == heap->capacity && Name##Grow(heap, heap->length + 1))  \
+      return 1;                                                                \
+                                                                               \
+    Name##SiftUp(heap->array, heap->length++, value);                          \
+    return 0;                                                                  \
+  }                                                                            \
+                                                                               \
+  /* Adds several values; returns `0` on success, `1` (adding none) if the */  \
+  /* heap didn't have room for all of them. Large batches are appended and */  \
+  /* the heap rebuilt, which is cheaper than pushing them one by one. */       \
+  static inline int Name##PushMany(Name *heap, Type *values, int count) {      \
+    if (count > heap->maxSize - heap->length) {                                \
+      printf("Error: stack overflow: heap doesn't have room for every "        \
+             "value.\n");                                                      \
+      return 1;                                                                \
+    }                                                                          \
+                                                                               \
+    if (Name##Grow(heap, heap->length + count))                                \
+      return 1;                                                                \
+                                                                               \
+    /* Pushing costs up to one swap per level of the tree for each value, */   \
+    /* while rebuilding costs at most about two swaps per value in total */    \
+    int depth = 0;                                                             \
+    for (int n = heap->length + count; n > 1; n /= 2) {                        \
+      depth++;                                                                 \
+    }                                                                          \
+                                                                               \
+    if ((long long)count * depth > 2LL * (heap->length + count)) {             \
+      memcpy(heap->array + heap->length, values, count * sizeof(Type));        \
+      heap->length += count;                                                   \
+      Name##Heapify(heap);                                                     \
+    } else {                                                                   \
+      for (int i = 0; i < count; i++) {                                        \
+        Name##SiftUp(heap->array, heap->length++, values[i]);                  \
+      }                                                                        \
+    }                                                                          \
+                                                                               \
+    return 0;                                                                  \
+  }                                                                            \
+                                                                               \
+  /* Removes the top value into `*out`; returns `0` on success, `1` if the */  \
+  /* heap was already empty. */                                                \
+  static inline int Name##Pop(Name *heap, Type *out) {                         \
+    if (heap->length == 0)                                                     \
+      return 1;                                                                \
+                                                                               \
+    *out = heap->array[0];                                                     \
+    heap->length--;                                                            \
+    if (heap->length > 0)                                                      \
+      Name##SiftDown(heap->array, heap->length, 0, heap->array[heap->length]); \
+                                                                               \
+    return 0;                                                                  \
+  }                                                                            \
+                                                                               \
+  /* Constructs a new heap from a copy of an array in O(n) (Floyd's */         \
+  /* method); returns `NULL` if `maxSize` is smaller than `length`. */         \
+  static inline Name *Name##FromArray(Type *values, int length,                \
+                                      int maxSize) {                           \
+    if (length < 0 || maxSize < length) {                                      \
+      printf("Error: maximum size must be at least the number of values.\n");  \
+      return NULL;                                                             \
+    }                                                                          \
+                                                                               \
+    Name *heap = new##Name(maxSize);                                           \
+    if (!heap)                                                                 \
+      return NULL;                                                             \
+                                                                               \
+    if (Name##Reserve(heap, length)) {                                         \
+      Name##Destroy(heap);                                                     \
+      return NULL;                                                             \
+    }                                                                          \
+                                                                               \
+    memcpy(heap->array, values, length * sizeof(Type));                        \
+    heap->length = length;                                                     \
+    Name##Heapify(heap);                                                       \
+    return heap;                                                               \
+  }                                                                            \
+                                                                               \
+  /* Creates a deep clone of a heap, or returns `NULL` if memory couldn't */   \
+  /* be allocated. */                                                          \
+  static inline Name *Name##Clone(Name *original) {                            \
+    Name *clone = new##Name(original->maxSize);                                \
+    if (Name##Reserve(clone, original->length)) {                              \
+      Name##Destroy(clone);                                                    \
+      return NULL;                                                             \
+    }                                                                          \
+                                                                               \
+    memcpy(clone->array, original->array, original->length * sizeof(Type));    \
+    clone->length = original->length;                                          \
+    return clone;                                                              \
+  }                                                                            \
+                                                                               \
+  /* Writes every value into `buffer` in the order they would be popped, */    \
+  /* leaving the heap unchanged, and returns how many were written. The */     \
+  /* copy is heapsorted in place, so no memory is allocated. */                \
+  static inline int Name##Sort(Name *heap, Type *buffer) {                     \
+    int n = heap->length;                                                      \
+    memcpy(buffer, heap->array, n * sizeof(Type));                             \
+                                                                               \
+    /* The copy is already a heap; repeatedly swapping its root to the end */  \
+    /* leaves the values in reverse popping order */                           \
+    for (int end = n - 1; end > 0; end--) {                                    \
+      Type root = buffer[0];                                                   \
+      Name##SiftDown(buffer, end, 0, buffer[end]);                             \
+      buffer[end] = root;                                                      \
+    }                                                                          \
+                                                                               \
+    for (int i = 0; i < n / 2; i++) {                                          \
+      Type temp = buffer[i];                                                   \
+      buffer[i] = buffer[n - 1 - i];                                           \
+      buffer[n - 1 - i] = temp;                                                \
+    }                                                                          \
+                                                                               \
+    return n;                                                                  \
+  }
+
+#endif
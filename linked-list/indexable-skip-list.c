@@ -0,0 +1,503 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/** The most levels a node can have, enough for billions of elements. */
+#define MAX_LEVEL 16
+
+/**
+ * A forward pointer on one level of a node, along with its span: the number
+ * of positions it skips ahead. A `NULL` pointer leads to the position just
+ * past the end of the list.
+ */
+typedef struct Level {
+  struct Node *next;
+  int span;
+} Level;
+
+typedef struct Node {
+  char *element;
+  int height;
+  Level levels[];
+} Node;
+
+static Node *newNode(char *element, int height) {
+  Node *ptr = malloc(sizeof(Node) + height * sizeof(Level));
+
+  ptr->element = element;
+  ptr->height = height;
+
+  return ptr;
+}
+
+/*
+ * An indexable skip list: a linked list where each node also links ahead on
+ * up to `MAX_LEVEL - 1` express lanes, with about a quarter of the nodes on
+ * each level also appearing on the next. Every forward pointer records how
+ * many positions it spans, so finding the node at an index adds up spans from
+ * the top level down, taking O(log n) expected time for positional access,
+ * insertion and removal. Level `0` links every node in order, as in
+ * `LinkedList`, so iterating through the list still takes O(1) per element.
+ *
+ * Positions count from `0`, and the head is a sentinel node at position `-1`
+ * with every level.
+ */
+typedef struct IndexableSkipList {
+  int length;
+  int height; // The highest level in use, plus one
+  Node *head;
+} IndexableSkipList;
+
+IndexableSkipList *newIndexableSkipList() {
+  IndexableSkipList *ptr = malloc(sizeof(IndexableSkipList));
+
+  ptr->length = 0;
+  ptr->height = 1;
+  ptr->head = newNode(NULL, MAX_LEVEL);
+  for (int i = 0; i < MAX_LEVEL; i++) {
+    ptr->head->levels[i] = (Level){NULL, 1};
+  }
+
+  return ptr;
+}
+
+/** Returns the number of elements in an indexable skip list. */
+int size(IndexableSkipList *list) { return list->length; }
+
+/** Returns whether or not an indexable skip list is empty. */
+bool isEmpty(IndexableSkipList *list) { return size(list) == 0; }
+
+/**
+ * Picks a height for a new node: each extra level has a one in four chance,
+ * taken two random bits at a time.
+ */
+static int randomHeight() {
+  int bits = rand() | (1 << 2 * (MAX_LEVEL - 1));
+  return 1 + __builtin_ctz(bits) / 2;
+}
+
+/**
+ * Finds, on every level, the last node before a given position of an
+ * indexable skip list, along with that node's position.
+ *
+ * @param list A pointer to the indexable skip list.
+ * @param index The position to search for.
+ * @param update An array that will receive the last node before `index` on
+ *   each level.
+ * @param positions An array that will receive the positions of those nodes.
+ */
+static void findPredecessors(IndexableSkipList *list, int index,
+                             Node *update[MAX_LEVEL],
+                             int positions[MAX_LEVEL]) {
+  Node *currentNode = list->head;
+  int position = -1;
+  for (int level = MAX_LEVEL - 1; level >= 0; level--) {
+    Level *lane = &currentNode->levels[level];
+    while (lane->next && position + lane->span < index) {
+      position += lane->span;
+      currentNode = lane->next;
+      lane = &currentNode->levels[level];
+    }
+
+    update[level] = currentNode;
+    positions[level] = position;
+  }
+}
+
+/**
+ * Unlinks a node from an indexable skip list and frees it, given the last
+ * node before it on every level.
+ *
+ * @return The removed node's element.
+ */
+static char *unlinkNode(IndexableSkipList *list, Node *update[MAX_LEVEL],
+                        Node *removedNode) {
+  for (int level = 0; level < MAX_LEVEL; level++) {
+    Level *lane = &update[level]->levels[level];
+    if (lane->next == removedNode) {
+      lane->next = removedNode->levels[level].next;
+      lane->span += removedNode->levels[level].span - 1;
+    } else {
+      lane->span--;
+    }
+  }
+
+  while (list->height > 1 && !list->head->levels[list->height - 1].next) {
+    list->height--;
+  }
+  list->length--;
+
+  char *removedElement = removedNode->element;
+  free(removedNode);
+  return removedElement;
+}
+
+/**
+ * Inserts a given element at a given index in an indexable skip list.
+ *
+ * @param list A pointer to the indexable skip list.
+ * @param index The index at which to insert the element.
+ * @param element The element to be inserted.
+ * @return `0` if the element was successfully inserted, `1` if given an invalid
+ *   index.
+ */
+int insertAt(IndexableSkipList *list, int index, char *element) {
+  if (index < 0 || index > list->length) {
+    return 1;
+  }
+
+  Node *update[MAX_LEVEL];
+  int positions[MAX_LEVEL];
+  findPredecessors(list, index, update, positions);
+
+  Node *node = newNode(element, randomHeight());
+  if (node->height > list->height)
+    list->height = node->height;
+
+  for (int level = 0; level < MAX_LEVEL; level++) {
+    Level *lane = &update[level]->levels[level];
+    if (level < node->height) {
+      // Split the predecessor's span around the new node, counting the shift
+      // of everything after it
+      node->levels[level].next = lane->next;
+      node->levels[level].span = positions[level] + lane->span + 1 - index;
+      lane->next = node;
+      lane->span = index - positions[level];
+    } else {
+      lane->span++;
+    }
+  }
+
+  list->length++;
+  return 0;
+}
+
+/**
+ * Adds a new element to the end of an indexable skip list.
+ *
+ * @param list A pointer to the indexable skip list.
+ * @param element The element to be added.
+ */
+void add(IndexableSkipList *list, char *element) {
+  insertAt(list, list->length, element);
+}
+
+/**
+ * Adds a new element to the start of an indexable skip list.
+ *
+ * @param list A pointer to the indexable skip list.
+ * @param element The element to be added.
+ */
+void prepend(IndexableSkipList *list, char *element) {
+  insertAt(list, 0, element);
+}
+
+/**
+ * Returns the element at a given index in an indexable skip list (or `NULL` if
+ * the list has no such index).
+ */
+char *elementAt(IndexableSkipList *list, int index) {
+  if (index < 0 || index >= list->length) {
+    return NULL;
+  }
+
+  Node *currentNode = list->head;
+  int position = -1;
+  for (int level = list->height - 1; level >= 0; level--) {
+    Level *lane = &currentNode->levels[level];
+    while (lane->next && position + lane->span <= index) {
+      position += lane->span;
+      currentNode = lane->next;
+      lane = &currentNode->levels[level];
+    }
+
+    if (position == index)
+      break;
+  }
+
+  return currentNode->element;
+}
+
+/**
+ * Removes and returns the element at a given index from an indexable skip
+ * list (or returns `NULL` if the list has no such index).
+ */
+char *removeAt(IndexableSkipList *list, int index) {
+  if (index < 0 || index >= list->length) {
+    return NULL;
+  }
+
+  Node *update[MAX_LEVEL];
+  int positions[MAX_LEVEL];
+  findPredecessors(list, index, update, positions);
+
+  return unlinkNode(list, update, update[0]->levels[0].next);
+}
+
+/**
+ * Removes up to a given number of occurrences of an element from an indexable
+ * skip list in a single pass along level `0`, keeping track of the last node
+ * passed on every level so that each removal needs no search.
+ */
+static int removeMatches(IndexableSkipList *list, char *element,
+                         int maxCount) {
+  Node *update[MAX_LEVEL];
+  for (int level = 0; level < MAX_LEVEL; level++) {
+    update[level] = list->head;
+  }
+
+  int removed = 0;
+  Node *currentNode = list->head;
+  while (removed < maxCount && currentNode->levels[0].next) {
+    Node *nextNode = currentNode->levels[0].next;
+    if (nextNode->element == element) {
+      unlinkNode(list, update, nextNode);
+      removed++;
+    } else {
+      currentNode = nextNode;
+      for (int level = 0; level < currentNode->height; level++) {
+        update[level] = currentNode;
+      }
+    }
+  }
+
+  return removed;
+}
+
+/**
+ * Removes the first occurrence of a given element from an indexable skip list
+ * (if possible).
+ *
+ * @param list A pointer to the indexable skip list.
+ * @param element The element to be removed.
+ * @return The number of occurrences removed.
+ */
+int removeOne(IndexableSkipList *list, char *element) {
+  return removeMatches(list, element, 1);
+}
+
+/**
+ * Removes all occurrences of a given element from an indexable skip list.
+ *
+ * @param list A pointer to the indexable skip list.
+ * @param element The element to be removed.
+ * @return The number of occurrences removed.
+ */
+int removeAll(IndexableSkipList *list, char *element) {
+  return removeMatches(list, element, list->length);
+}
+
+/**
+ * Returns the numerical index of the first occurrence of a given element in an
+ * indexable skip list (or `-1` if the list does not contain this element).
+ */
+int indexOf(IndexableSkipList *list, char *element) {
+  int index = 0;
+  Node *currentNode = list->head->levels[0].next;
+  while (currentNode) {
+    if (currentNode->element == element) {
+      return index;
+    }
+    currentNode = currentNode->levels[0].next;
+    index++;
+  }
+
+  return -1;
+}
+
+/** Clears the contents of an indexable skip list. */
+void clear(IndexableSkipList *list) {
+  // Free allocated memory
+  Node *currentNode = list->head->levels[0].next;
+  while (currentNode) {
+    Node *nextNode = currentNode->levels[0].next;
+    free(currentNode);
+    currentNode = nextNode;
+  }
+
+  for (int i = 0; i < MAX_LEVEL; i++) {
+    list->head->levels[i] = (Level){NULL, 1};
+  }
+  list->height = 1;
+  list->length = 0;
+}
+
+/** Frees the allocated memory for an indexable skip list and its contents. */
+void destroy(IndexableSkipList *list) {
+  clear(list);
+  free(list->head);
+  free(list);
+}
+
+/**
+ * Prints the contents of an indexable skip list to a console, separated by
+ * commas.
+ */
+void print(IndexableSkipList *list) {
+  Node *currentNode = list->head->levels[0].next;
+  if (currentNode) {
+    printf("\"%s\"", currentNode->element);
+    currentNode = currentNode->levels[0].next;
+    while (currentNode) {
+      printf(", \"%s\"", currentNode->element);
+      currentNode = currentNode->levels[0].next;
+    }
+  }
+  printf("\n");
+}
+
+/** Checks that every span matches the positions of the nodes it links. */
+static bool hasValidSpans(IndexableSkipList *list) {
+  for (int level = 0; level < MAX_LEVEL; level++) {
+    // Positions of the nodes on this level, found by walking level 0
+    Node *laneNode = list->head;
+    int lanePosition = -1;
+    Node *currentNode = list->head;
+    for (int position = -1; position <= list->length; position++) {
+      Node *nextNode = currentNode ? currentNode->levels[0].next : NULL;
+      bool onLane = position == list->length ||
+                    (position >= 0 && currentNode->height > level);
+      if (onLane) {
+        if (laneNode->levels[level].next !=
+                (position == list->length ? NULL : currentNode) ||
+            laneNode->levels[level].span != position - lanePosition)
+          return false;
+        if (position < list->length) {
+          laneNode = currentNode;
+          lanePosition = position;
+        }
+      }
+      currentNode = nextNode;
+    }
+  }
+
+  return true;
+}
+
+static double secondsSince(struct timespec *start) {
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/** Makes random positional edits and lookups on a list of `n` elements. */
+static void benchmark(int n) {
+  IndexableSkipList *list = newIndexableSkipList();
+  char *element = "x";
+  for (int i = 0; i < n; i++) {
+    add(list, element);
+  }
+
+  struct timespec start;
+  int edits = 1000000;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < edits; i++) {
+    insertAt(list, rand() % (list->length + 1), element);
+    removeAt(list, rand() % list->length);
+    assert(elementAt(list, rand() % list->length) == element);
+  }
+  printf("%d random insertions, removals and lookups at %d elements: %.3fs\n",
+         edits, n, secondsSince(&start));
+
+  destroy(list);
+}
+
+int main(int argc, char *argv[]) {
+  IndexableSkipList *l = newIndexableSkipList();
+
+  print(l);
+  assert(isEmpty(l));
+
+  add(l, "hey");
+  add(l, "unicorn");
+  assert(size(l) == 2);
+  print(l);
+
+  add(l, "squirrel");
+  add(l, "opera");
+  assert(insertAt(l, 2, "gait") == 0);
+  assert(insertAt(l, 6, "gait") == 1);
+  assert(indexOf(l, "squirrel") == 3);
+
+  assert(removeOne(l, "boring") == 0);
+  add(l, "unicorn");
+  assert(removeAll(l, "unicorn") == 2);
+
+  assert(strcmp(elementAt(l, 1), "gait") == 0);
+  assert(elementAt(l, 4) == NULL);
+  assert(strcmp(removeAt(l, 0), "hey") == 0);
+  assert(size(l) == 3);
+  assert(!isEmpty(l));
+
+  print(l);
+
+  clear(l);
+  assert(isEmpty(l));
+
+  // Spans stay correct through random edits at random positions
+  char names[100][8];
+  char *mirror[2000];
+  int mirrorLength = 0;
+  for (int i = 0; i < 100; i++) {
+    snprintf(names[i], sizeof(names[i]), "%d", i);
+  }
+  for (int step = 0; step < 20000; step++) {
+    if (mirrorLength < 2000 && (rand() % 3 < 2 || mirrorLength == 0)) {
+      int index = rand() % (mirrorLength + 1);
+      char *element = names[rand() % 100];
+      assert(insertAt(l, index, element) == 0);
+      memmove(mirror + index + 1, mirror + index,
+              (mirrorLength - index) * sizeof(char *));
+      mirror[index] = element;
+      mirrorLength++;
+    } else {
+      int index = rand() % mirrorLength;
+      assert(removeAt(l, index) == mirror[index]);
+      memmove(mirror + index, mirror + index + 1,
+              (mirrorLength - index - 1) * sizeof(char *));
+      mirrorLength--;
+    }
+
+    int probe = rand() % (mirrorLength + 1);
+    char *expected = probe < mirrorLength ? mirror[probe] : NULL;
+    assert(elementAt(l, probe) == expected);
+  }
+  assert(size(l) == mirrorLength);
+  assert(hasValidSpans(l));
+  for (int i = 0; i < mirrorLength; i++) {
+    assert(elementAt(l, i) == mirror[i]);
+  }
+
+  // Removing by value keeps the spans correct
+  int occurrences = 0;
+  for (int i = 0; i < mirrorLength; i++) {
+    occurrences += mirror[i] == names[3];
+  }
+  assert(removeAll(l, names[3]) == occurrences);
+  assert(indexOf(l, names[3]) == -1);
+  assert(hasValidSpans(l));
+  int index = indexOf(l, names[4]);
+  if (index != -1) {
+    assert(removeOne(l, names[4]) == 1);
+    assert(hasValidSpans(l));
+  }
+  assert(size(l) == mirrorLength - occurrences - (index != -1));
+
+  while (!isEmpty(l)) {
+    removeAt(l, size(l) / 2);
+  }
+  assert(l->height == 1);
+  assert(hasValidSpans(l));
+
+  destroy(l);
+  printf("All tests passed successfully.\n");
+
+  // Pass `bench [number of elements]` to time random positional edits
+  if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    benchmark(argc > 2 ? atoi(argv[2]) : 1000000);
+
+  return 0;
+}
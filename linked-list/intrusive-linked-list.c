@@ -0,0 +1,249 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Returns a pointer to the struct of a given type that contains a given link
+ * as the given member.
+ */
+#define CONTAINER_OF(link, type, member)                                       \
+  ((type *)((char *)(link) - offsetof(type, member)))
+
+/**
+ * The link field of an intrusive linked list, to be embedded in the struct of
+ * each object that goes on the list. An object with several links can be on
+ * several lists at once, but each link can only be on one list at a time.
+ */
+typedef struct Link {
+  struct Link *next;
+} Link;
+
+/**
+ * An intrusive linked list, whose nodes are links embedded in the objects on
+ * the list rather than nodes it allocates itself, so adding an object never
+ * allocates and reaching it from a node takes no extra pointer hop. Like
+ * `LinkedList`, it keeps a tail pointer for O(1) appends.
+ *
+ * The list doesn't own its objects: destroying it only forgets them.
+ */
+typedef struct IntrusiveLinkedList {
+  int length;
+  Link *head;
+  Link *tail;
+} IntrusiveLinkedList;
+
+/**
+ * Constructs a new intrusive linked list and returns a pointer to it. (Make
+ * sure to `destroy` the list once you're finished with it.)
+ */
+IntrusiveLinkedList *newIntrusiveLinkedList() {
+  IntrusiveLinkedList *ptr = malloc(sizeof(IntrusiveLinkedList));
+
+  ptr->length = 0;
+  ptr->head = NULL;
+  ptr->tail = NULL;
+
+  return ptr;
+}
+
+/** Returns the number of links in an intrusive linked list. */
+int size(IntrusiveLinkedList *list) { return list->length; }
+
+/** Returns whether or not an intrusive linked list is empty. */
+bool isEmpty(IntrusiveLinkedList *list) { return size(list) == 0; }
+
+/**
+ * Adds a link to the tail end of an intrusive linked list. The link must not
+ * already be on a list.
+ */
+void add(IntrusiveLinkedList *list, Link *link) {
+  link->next = NULL;
+  if (list->tail) {
+    list->tail->next = link;
+  } else {
+    list->head = link;
+  }
+  list->tail = link;
+  list->length++;
+}
+
+/**
+ * Adds a link to the head end of an intrusive linked list. The link must not
+ * already be on a list.
+ */
+void prepend(IntrusiveLinkedList *list, Link *link) {
+  link->next = list->head;
+  list->head = link;
+  if (!list->tail)
+    list->tail = link;
+  list->length++;
+}
+
+/**
+ * Removes the link at the head of an intrusive linked list.
+ *
+ * @return The removed link, or `NULL` if the list is empty.
+ */
+Link *removeFirst(IntrusiveLinkedList *list) {
+  Link *link = list->head;
+  if (!link)
+    return NULL;
+
+  list->head = link->next;
+  if (!list->head)
+    list->tail = NULL;
+  link->next = NULL;
+  list->length--;
+
+  return link;
+}
+
+/**
+ * Removes a given link from an intrusive linked list (if possible), which
+ * takes O(n) time to find the link before it.
+ *
+ * @param list A pointer to the intrusive linked list.
+ * @param link The link to be removed.
+ * @return `0` if the link was removed, `1` if it wasn't on the list.
+ */
+int removeLink(IntrusiveLinkedList *list, Link *link) {
+  Link *previous = NULL;
+  for (Link *current = list->head; current; current = current->next) {
+    if (current == link) {
+      if (previous) {
+        previous->next = link->next;
+      } else {
+        list->head = link->next;
+      }
+      if (list->tail == link)
+        list->tail = previous;
+      link->next = NULL;
+      list->length--;
+      return 0;
+    }
+    previous = current;
+  }
+
+  return 1;
+}
+
+/** Returns whether or not an intrusive linked list contains a given link. */
+bool contains(IntrusiveLinkedList *list, Link *link) {
+  for (Link *current = list->head; current; current = current->next) {
+    if (current == link)
+      return true;
+  }
+
+  return false;
+}
+
+/** Removes every link from an intrusive linked list. */
+void clear(IntrusiveLinkedList *list) {
+  list->length = 0;
+  list->head = NULL;
+  list->tail = NULL;
+}
+
+/**
+ * Frees the allocated memory for an intrusive linked list. The objects on it
+ * are left alone.
+ */
+void destroy(IntrusiveLinkedList *list) { free(list); }
+
+/** An object that sits on two lists at once through its two links. */
+typedef struct Connection {
+  char *name;
+  Link byState; // On the list for the connection's state
+  Link byAge;   // On the list of every connection, oldest first
+} Connection;
+
+/**
+ * Prints the names of the connections on a list of `byState` links to the
+ * console, head to tail, separated by commas.
+ */
+static void print(IntrusiveLinkedList *list) {
+  for (Link *link = list->head; link; link = link->next) {
+    printf(link == list->head ? "\"%s\"" : ", \"%s\"",
+           CONTAINER_OF(link, Connection, byState)->name);
+  }
+  printf("\n");
+}
+
+/**
+ * Checks that a list holds exactly the given connections in order, through
+ * the given member, and that its tail is its last link.
+ */
+static bool holds(IntrusiveLinkedList *list, Connection **connections,
+                  int count, size_t member) {
+  Link *link = list->head;
+  for (int i = 0; i < count; i++, link = link->next) {
+    if (!link || (char *)link - member != (char *)connections[i])
+      return false;
+  }
+  if (link || size(list) != count)
+    return false;
+
+  return count == 0 ? list->tail == NULL
+                    : (char *)list->tail - member ==
+                          (char *)connections[count - 1];
+}
+
+int main() {
+  char *names[] = {"hey", "unicorn", "squirrel", "opera", "boring"};
+  Connection connections[5];
+  Connection *c[5];
+  for (int i = 0; i < 5; i++) {
+    c[i] = &connections[i];
+    c[i]->name = names[i];
+  }
+  size_t byState = offsetof(Connection, byState);
+  size_t byAge = offsetof(Connection, byAge);
+
+  IntrusiveLinkedList *open = newIntrusiveLinkedList();
+  IntrusiveLinkedList *idle = newIntrusiveLinkedList();
+  IntrusiveLinkedList *all = newIntrusiveLinkedList();
+
+  print(open);
+  assert(isEmpty(open));
+  assert(removeFirst(open) == NULL);
+
+  // Every connection is on `all`, and on one of `open` or `idle`
+  for (int i = 0; i < 5; i++) {
+    add(all, &c[i]->byAge);
+    add(i % 2 == 0 ? open : idle, &c[i]->byState);
+  }
+  print(open);
+  assert(CONTAINER_OF(open->head, Connection, byState) == c[0]);
+  assert(holds(open, (Connection *[]){c[0], c[2], c[4]}, 3, byState));
+  assert(holds(idle, (Connection *[]){c[1], c[3]}, 2, byState));
+  assert(holds(all, c, 5, byAge));
+
+  // Moving a connection between lists leaves its other list alone
+  assert(removeLink(open, &c[4]->byState) == 0);
+  assert(removeLink(open, &c[4]->byState) == 1);
+  prepend(idle, &c[4]->byState);
+  assert(holds(open, (Connection *[]){c[0], c[2]}, 2, byState));
+  assert(holds(idle, (Connection *[]){c[4], c[1], c[3]}, 3, byState));
+  assert(holds(all, c, 5, byAge));
+  assert(contains(idle, &c[4]->byState));
+  assert(!contains(open, &c[4]->byState));
+
+  assert(removeFirst(open) == &c[0]->byState);
+  add(idle, &c[0]->byState);
+  assert(removeLink(idle, &c[0]->byState) == 0);
+  add(idle, &c[0]->byState);
+  assert(holds(open, (Connection *[]){c[2]}, 1, byState));
+  assert(holds(idle, (Connection *[]){c[4], c[1], c[3], c[0]}, 4, byState));
+
+  clear(all);
+  assert(holds(all, NULL, 0, byAge));
+
+  destroy(open);
+  destroy(idle);
+  destroy(all);
+  printf("All tests passed successfully.\n");
+
+  return 0;
+}
@@ -3,14 +3,17 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+
+#include "../node-pool/node-pool.h"
 
 typedef struct Node {
   char *element;
   struct Node *next;
 } Node;
 
-static Node *newNode(char *element) {
-  Node *ptr = malloc(sizeof(Node));
+static Node *newNode(NodePool *pool, char *element) {
+  Node *ptr = poolAlloc(pool);
 
   ptr->element = element;
   ptr->next = NULL;
@@ -20,18 +23,50 @@ static Node *newNode(char *element) {
 
 /*
  * A linked list data structure, where each node in the list will contain a
- * reference to the node after it.
+ * reference to the node after it. The list also keeps a reference to its last
+ * node, so that elements can be added to either end in constant time.
  */
 typedef struct LinkedList {
   int length;
   Node *head;
+  Node *tail;
+  NodePool *pool; // Where the list's nodes are allocated from
+  bool ownsPool;
 } LinkedList;
 
-LinkedList *newLinkedList() {
+/** The number of nodes a linked list's own pool allocates at a time. */
+#define NODES_PER_SLAB 256
+
+/**
+ * Constructs a new linked list that allocates its nodes from a node pool
+ * shared with other lists, and returns a pointer to it. (Make sure to
+ * `destroy` the list once you're finished with it, before the pool.)
+ */
+LinkedList *newLinkedListInPool(NodePool *pool) {
+  if (pool->nodeSize < sizeof(Node)) {
+    printf("Error: node pool's nodes are too small for a linked list.\n");
+    return NULL;
+  }
+
   LinkedList *ptr = malloc(sizeof(LinkedList));
 
   ptr->length = 0;
   ptr->head = NULL;
+  ptr->tail = NULL;
+  ptr->pool = pool;
+  ptr->ownsPool = false;
+
+  return ptr;
+}
+
+/**
+ * Constructs a new linked list with its own node pool and returns a pointer
+ * to it. (Make sure to `destroy` the list once you're finished with it.)
+ */
+LinkedList *newLinkedList() {
+  NodePool *pool = newNodePool(sizeof(Node), NODES_PER_SLAB);
+  LinkedList *ptr = newLinkedListInPool(pool);
+  ptr->ownsPool = true;
 
   return ptr;
 }
@@ -49,15 +84,28 @@ bool isEmpty(LinkedList *list) { return size(list) == 0; }
  * @param element The element to be added.
  */
 void add(LinkedList *list, char *element) {
-  if (list->head) {
-    Node *currentNode = list->head;
-    while (currentNode->next) {
-      currentNode = currentNode->next;
-    }
-    currentNode->next = newNode(element);
+  Node *node = newNode(list->pool, element);
+  if (list->tail) {
+    list->tail->next = node;
   } else {
-    list->head = newNode(element);
+    list->head = node;
   }
+  list->tail = node;
+  list->length++;
+}
+
+/**
+ * Adds a new element to the start of a linked list.
+ *
+ * @param list A pointer to the linked list.
+ * @param element The element to be added.
+ */
+void prepend(LinkedList *list, char *element) {
+  Node *node = newNode(list->pool, element);
+  node->next = list->head;
+  list->head = node;
+  if (!list->tail)
+    list->tail = node;
   list->length++;
 }
 
@@ -75,9 +123,11 @@ int removeOne(LinkedList *list, char *element) {
       Node *removedNode = list->head;
 
       list->head = list->head->next;
+      if (!list->head)
+        list->tail = NULL;
       list->length--;
 
-      free(removedNode);
+      poolFree(list->pool, removedNode);
       return 1;
     } else {
       // Search for element
@@ -87,9 +137,11 @@ int removeOne(LinkedList *list, char *element) {
         if (currentNode->element == element) {
           // Link adjacent nodes to each other
           previousNode->next = currentNode->next;
+          if (currentNode == list->tail)
+            list->tail = previousNode;
           list->length--;
 
-          free(currentNode);
+          poolFree(list->pool, currentNode);
           return 1;
         }
 
@@ -117,13 +169,18 @@ int removeAll(LinkedList *list, char *element) {
   int oldLength = list->length;
 
   // Remove as many heads as necessary
-  while (list->head->element == element) {
+  while (list->head && list->head->element == element) {
     Node *removedNode = list->head;
 
     list->head = list->head->next;
     list->length--;
 
-    free(removedNode);
+    poolFree(list->pool, removedNode);
+  }
+
+  if (!list->head) {
+    list->tail = NULL;
+    return oldLength;
   }
 
   // Search the rest of list for element
@@ -138,12 +195,13 @@ int removeAll(LinkedList *list, char *element) {
       list->length--;
 
       currentNode = currentNode->next;
-      free(removedNode);
+      poolFree(list->pool, removedNode);
     } else {
       previousNode = currentNode;
       currentNode = currentNode->next;
     }
   }
+  list->tail = previousNode;
 
   return oldLength - list->length;
 }
@@ -195,10 +253,12 @@ char *removeAt(LinkedList *list, int index) {
     Node *removedNode = list->head;
 
     list->head = list->head->next;
+    if (!list->head)
+      list->tail = NULL;
     list->length--;
 
     char *removedElement = removedNode->element;
-    free(removedNode);
+    poolFree(list->pool, removedNode);
     return removedElement;
   } else {
     // Find nodes at and around index
@@ -212,10 +272,12 @@ char *removeAt(LinkedList *list, int index) {
     }
 
     previousNode->next = currentNode->next;
+    if (currentNode == list->tail)
+      list->tail = previousNode;
     list->length--;
 
     char *removedElement = currentNode->element;
-    free(currentNode);
+    poolFree(list->pool, currentNode);
     return removedElement;
   }
 }
@@ -235,10 +297,9 @@ int insertAt(LinkedList *list, int index, char *element) {
   }
 
   if (index == 0) {
-    Node *oldHead = list->head;
-    list->head = newNode(element);
-    list->head->next = oldHead;
-    list->length++;
+    prepend(list, element);
+  } else if (index == list->length) {
+    add(list, element);
   } else {
     // Find nodes at and around index
     int currentIndex = 1;
@@ -251,7 +312,7 @@ int insertAt(LinkedList *list, int index, char *element) {
     }
 
     // Add and link up
-    previousNode->next = newNode(element);
+    previousNode->next = newNode(list->pool, element);
     previousNode->next->next = currentNode;
 
     list->length++;
@@ -260,26 +321,159 @@ int insertAt(LinkedList *list, int index, char *element) {
   return 0;
 }
 
-/** Clears the contents of a linked list. */
+/**
+ * Clears the contents of a linked list. A list with its own node pool resets
+ * the pool in O(1) time; a list sharing a pool gives its nodes back one by one.
+ */
 void clear(LinkedList *list) {
-  // Free allocated memory
-  Node *currentNode = list->head;
-  while (currentNode) {
-    Node *nextNode = currentNode->next;
-    free(currentNode);
-    currentNode = nextNode;
+  if (list->ownsPool) {
+    poolReset(list->pool);
+  } else {
+    Node *currentNode = list->head;
+    while (currentNode) {
+      Node *nextNode = currentNode->next;
+      poolFree(list->pool, currentNode);
+      currentNode = nextNode;
+    }
   }
 
   list->head = NULL;
+  list->tail = NULL;
   list->length = 0;
 }
 
 /** Frees the allocated memory for a linked list and its contents. */
 void destroy(LinkedList *list) {
-  clear(list);
+  if (list->ownsPool) {
+    destroyNodePool(list->pool);
+  } else {
+    clear(list);
+  }
   free(list);
 }
 
+/**
+ * A comparator for elements: returns a negative number if `a` belongs before
+ * `b`, a positive number if `a` belongs after `b`, or `0` if they are equal.
+ * (`strcmp` orders strings alphabetically.)
+ */
+typedef int (*Comparator)(const char *a, const char *b);
+
+/**
+ * Merges two sorted chains of nodes linked by `next` into one. Ties take the
+ * node from the left chain first, which keeps sorting stable.
+ *
+ * @return The first node of the merged chain.
+ */
+static Node *mergeChains(Node *left, Node *right, Comparator compare) {
+  Node start = {.next = NULL};
+  Node *tail = &start;
+  while (left && right) {
+    // Start loading the next nodes while the current ones are compared
+    __builtin_prefetch(left->next);
+    __builtin_prefetch(right->next);
+    if (compare(left->element, right->element) <= 0) {
+      tail->next = left;
+      left = left->next;
+    } else {
+      tail->next = right;
+      right = right->next;
+    }
+    tail = tail->next;
+  }
+
+  tail->next = left ? left : right;
+  return start.next;
+}
+
+/**
+ * Sorts a linked list in place with a bottom-up merge sort, in O(n log n)
+ * time. Nodes are relinked rather than their elements copied, no memory is
+ * allocated, and equal elements keep their relative order.
+ *
+ * @param list A pointer to the linked list.
+ * @param compare The comparator to order elements by.
+ */
+void sort(LinkedList *list, Comparator compare) {
+  // Sorted runs pending a merge, where `runs[i]` holds 2^i nodes or is empty.
+  // Taking nodes one at a time and merging equal runs like a binary counter
+  // keeps each merge close to recently touched nodes, rather than sweeping the
+  // whole list once per doubling of the run length
+  Node *runs[32] = {NULL};
+  int maxRun = 0;
+
+  Node *node = list->head;
+  while (node) {
+    Node *carry = node;
+    node = node->next;
+    carry->next = NULL;
+
+    // Earlier nodes are always in the left run, so ties stay in order
+    int i = 0;
+    for (; runs[i]; i++) {
+      carry = mergeChains(runs[i], carry, compare);
+      runs[i] = NULL;
+    }
+    runs[i] = carry;
+    if (i > maxRun)
+      maxRun = i;
+  }
+
+  // Merge what's left, from the newest run to the oldest
+  Node *sorted = NULL;
+  for (int i = 0; i <= maxRun; i++) {
+    if (runs[i])
+      sorted = sorted ? mergeChains(runs[i], sorted, compare) : runs[i];
+  }
+
+  list->head = sorted;
+  list->tail = list->head;
+  while (list->tail && list->tail->next) {
+    list->tail = list->tail->next;
+  }
+}
+
+/**
+ * Merges another sorted linked list into a sorted linked list
+ * in O(n + m) time, leaving the other list empty. Nodes are relinked rather
+ * than copied when both lists share a node pool; otherwise they are moved into
+ * the first list's pool. On ties, elements of the first list come first.
+ * Merging a list into itself does nothing.
+ *
+ * @param list A pointer to the linked list to merge into.
+ * @param other A pointer to the linked list to merge from.
+ * @param compare The comparator both lists are sorted by.
+ */
+void mergeSorted(LinkedList *list, LinkedList *other, Comparator compare) {
+  if (other == list || isEmpty(other))
+    return;
+
+  if (other->pool != list->pool) {
+    // Copy the other list's nodes into this list's pool
+    LinkedList *moved = newLinkedListInPool(list->pool);
+    for (Node *node = other->head; node; node = node->next) {
+      add(moved, node->element);
+    }
+    clear(other);
+    other->head = moved->head;
+    other->tail = moved->tail;
+    other->length = moved->length;
+    free(moved);
+  }
+
+  // The merged list ends with whichever tail sorts last
+  Node *tail = other->tail;
+  if (list->tail && compare(list->tail->element, other->tail->element) > 0)
+    tail = list->tail;
+
+  list->head = mergeChains(list->head, other->head, compare);
+  list->tail = tail;
+  list->length += other->length;
+  other->length = 0;
+  other->head = NULL;
+  other->tail = NULL;
+}
+
 /** Prints the contents of a linked list to a console, separated by commas. */
 void print(LinkedList *list) {
   if (!isEmpty(list)) {
@@ -293,7 +487,82 @@ void print(LinkedList *list) {
   printf("\n");
 }
 
-int main() {
+/** Compares two strings by their first character only. */
+static int compareFirst(const char *a, const char *b) { return *a - *b; }
+
+static int compareStrings(const void *a, const void *b) {
+  return strcmp(*(char **)a, *(char **)b);
+}
+
+/**
+ * Checks that a list holds exactly the given elements in order, and that its
+ * tail is its last node.
+ */
+static bool holds(LinkedList *list, char **elements, int count) {
+  Node *node = list->head;
+  for (int i = 0; i < count; i++, node = node->next) {
+    if (!node || node->element != elements[i])
+      return false;
+  }
+  if (node)
+    return false;
+
+  return count == 0 ? list->tail == NULL : list->tail->next == NULL &&
+                                               list->tail->element ==
+                                                   elements[count - 1];
+}
+
+static double secondsSince(struct timespec *start) {
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * Sorts a list of `n` random strings in place, then by copying its elements
+ * out into an array, sorting that and rebuilding the list.
+ */
+static void benchmark(int n) {
+  char (*strings)[12] = malloc(n * sizeof(*strings));
+  srand(42);
+  for (int i = 0; i < n; i++) {
+    snprintf(strings[i], sizeof(strings[i]), "%07d", rand() % 10000000);
+  }
+
+  struct timespec start;
+  LinkedList *list = newLinkedList();
+  for (int i = 0; i < n; i++) {
+    add(list, strings[i]);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  sort(list, strcmp);
+  printf("in-place merge sort: %.3fs\n", secondsSince(&start));
+  destroy(list);
+
+  list = newLinkedList();
+  for (int i = 0; i < n; i++) {
+    add(list, strings[i]);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  char **elements = malloc(n * sizeof(char *));
+  int count = 0;
+  for (Node *node = list->head; node; node = node->next) {
+    elements[count++] = node->element;
+  }
+  qsort(elements, count, sizeof(char *), compareStrings);
+  destroy(list);
+  list = newLinkedList();
+  for (int i = 0; i < count; i++) {
+    add(list, elements[i]);
+  }
+  printf("copy out, sort and rebuild: %.3fs\n", secondsSince(&start));
+
+  free(elements);
+  destroy(list);
+  free(strings);
+}
+
+int main(int argc, char *argv[]) {
   LinkedList *l = newLinkedList();
 
   print(l);
@@ -323,8 +592,135 @@ int main() {
   clear(l);
   assert(isEmpty(l));
 
+  // The tail stays in step with the last node through every kind of change
+  prepend(l, "b");
+  prepend(l, "a");
+  assert(strcmp(l->tail->element, "b") == 0);
+  add(l, "c");
+  assert(insertAt(l, 3, "d") == 0);
+  assert(strcmp(l->tail->element, "d") == 0);
+  assert(strcmp(removeAt(l, 3), "d") == 0);
+  assert(strcmp(l->tail->element, "c") == 0);
+  assert(removeOne(l, "c") == 1);
+  assert(strcmp(l->tail->element, "b") == 0);
+  add(l, "a");
+  assert(removeAll(l, "a") == 2);
+  assert(l->head == l->tail);
+  assert(removeAll(l, "b") == 1);
+  assert(isEmpty(l));
+  assert(l->head == NULL && l->tail == NULL);
+
+  // Appending is constant time, so long lists build quickly
+  for (int i = 0; i < 1000000; i++) {
+    add(l, "x");
+  }
+  assert(size(l) == 1000000);
+  clear(l);
+  assert(l->tail == NULL);
+
+  // A fresh list's nodes are laid out one after another, and clearing reuses
+  // them from the start
+  add(l, "a");
+  Node *first = l->head;
+  add(l, "b");
+  add(l, "c");
+  assert((char *)l->head->next == (char *)first + l->pool->nodeSize);
+  assert((char *)l->tail == (char *)first + 2 * l->pool->nodeSize);
+  assert(removeOne(l, "b") == 1);
+  add(l, "d");
+  assert((char *)l->tail == (char *)first + l->pool->nodeSize);
+  clear(l);
+  add(l, "e");
+  assert(l->head == first);
+
   destroy(l);
+
+  // Lists sharing a pool reuse each other's freed nodes
+  NodePool *pool = newNodePool(sizeof(Node), 4);
+  assert(newNodePool(sizeof(Node), 0) == NULL);
+  LinkedList *a = newLinkedListInPool(pool);
+  LinkedList *b = newLinkedListInPool(pool);
+  for (int i = 0; i < 10; i++) {
+    add(a, "a");
+    add(b, "b");
+  }
+  Node *reused = a->head;
+  assert(strcmp(removeAt(a, 0), "a") == 0);
+  add(b, "b");
+  assert(b->tail == reused);
+  destroy(a);
+  assert(size(b) == 11);
+  destroy(b);
+  destroyNodePool(pool);
+
+  // Sorting relinks nodes into order, keeping equal elements in order
+  LinkedList *l2 = newLinkedList();
+  sort(l2, strcmp);
+  assert(isEmpty(l2) && l2->tail == NULL);
+  char strings[500][8];
+  char *expected[500];
+  for (int i = 0; i < 500; i++) {
+    snprintf(strings[i], sizeof(strings[i]), "%d", rand() % 1000);
+    add(l2, strings[i]);
+    expected[i] = strings[i];
+  }
+  sort(l2, strcmp);
+  qsort(expected, 500, sizeof(char *), compareStrings);
+  for (Node *node = l2->head; node->next; node = node->next) {
+    assert(strcmp(node->element, node->next->element) <= 0);
+  }
+  Node *node = l2->head;
+  for (int i = 0; i < 500; i++, node = node->next) {
+    assert(strcmp(node->element, expected[i]) == 0);
+  }
+
+  char *ties[] = {"b1", "a1", "b2", "c1", "a2", "b3"};
+  char *stable[] = {"a1", "a2", "b1", "b2", "b3", "c1"};
+  clear(l2);
+  for (int i = 0; i < 6; i++) {
+    add(l2, ties[i]);
+  }
+  sort(l2, compareFirst);
+  assert(holds(l2, stable, 6));
+  add(l2, "d1");
+  assert(strcmp(l2->tail->element, "d1") == 0);
+
+  // Merging sorted lists, whether or not they share a node pool
+  char *left[] = {"a1", "b1", "b2", "d1"};
+  char *right[] = {"a2", "b3", "c1", "e1"};
+  char *merged[] = {"a1", "a2", "b1", "b2", "b3", "c1", "d1", "e1"};
+  NodePool *shared = newNodePool(sizeof(Node), 4);
+  LinkedList *lists[][2] = {
+      {newLinkedList(), newLinkedList()},
+      {newLinkedListInPool(shared), newLinkedListInPool(shared)}};
+  for (int i = 0; i < 2; i++) {
+    LinkedList *a = lists[i][0];
+    LinkedList *b = lists[i][1];
+    for (int j = 0; j < 4; j++) {
+      add(a, left[j]);
+      add(b, right[j]);
+    }
+    mergeSorted(a, b, compareFirst);
+    assert(holds(a, merged, 8));
+    assert(isEmpty(b) && b->tail == NULL);
+    assert(size(a) == 8 && size(b) == 0);
+
+    mergeSorted(b, a, compareFirst);
+    assert(holds(b, merged, 8));
+    mergeSorted(b, a, compareFirst);
+    assert(holds(b, merged, 8));
+    mergeSorted(b, b, compareFirst);
+    assert(holds(b, merged, 8));
+    destroy(a);
+    destroy(b);
+  }
+  destroyNodePool(shared);
+  destroy(l2);
   printf("All tests passed successfully.\n");
 
+  // Pass `bench [number of elements]` to compare against sorting a copy
+  if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    benchmark(argc > 2 ? atoi(argv[2]) : 1000000);
+
   return 0;
 }
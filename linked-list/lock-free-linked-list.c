@@ -0,0 +1,599 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * A node whose `next` reference also carries a mark in its lowest bit. A
+ * marked node has been logically removed from the list, and no node may be
+ * linked after it any more; it is then physically unlinked by whichever thread
+ * comes across it first.
+ */
+typedef struct Node {
+  char *element;
+  _Atomic(uintptr_t) next;
+  struct Node *retiredNext; // Links nodes waiting to be freed
+} Node;
+
+#define MARK ((uintptr_t)1)
+
+static Node *pointer(uintptr_t next) { return (Node *)(next & ~MARK); }
+
+static bool isMarked(uintptr_t next) { return next & MARK; }
+
+static Node *newNode(char *element) {
+  Node *ptr = malloc(sizeof(Node));
+
+  ptr->element = element;
+  atomic_init(&ptr->next, 0);
+  ptr->retiredNext = NULL;
+
+  return ptr;
+}
+
+/** The number of nodes a thread retires between attempts to free them. */
+#define RETIRE_THRESHOLD 64
+
+/**
+ * A registered thread's view of the global epoch. While a thread is inside an
+ * operation, it is "pinned" to the epoch it saw on the way in (stored in
+ * `state` as `epoch << 1 | 1`), and no node it could still be reading will be
+ * freed. Nodes it unlinks are kept in one of three limbo lists, by the epoch
+ * in which they were unlinked, until no thread can still hold them.
+ */
+typedef struct ThreadRecord {
+  _Alignas(64) _Atomic(unsigned long) state;
+  atomic_bool inUse;
+  unsigned long lastEpoch; // The epoch this thread last pinned itself to
+  int retiredCount;
+  Node *limbo[3];
+} ThreadRecord;
+
+/*
+ * A lock-free sorted linked list (Harris's algorithm, with Michael's changes
+ * for safe memory reclamation) holding each element at most once, ordered by
+ * `strcmp`. Removing an element first marks its node's `next` reference, so
+ * that concurrent insertions after it fail, and only then unlinks it. Every
+ * operation only ever compares and swaps a single reference, so no thread can
+ * block another, and `contains` only reads shared memory apart from its own
+ * thread's record, so readers don't contend with each other.
+ *
+ * Unlinked nodes are freed with epoch-based reclamation: a global epoch only
+ * advances once every pinned thread has seen the current one, so nodes
+ * unlinked three epochs ago can no longer be reachable by any thread.
+ *
+ * Each thread must `registerThread` before using the list and pass the ID it
+ * gets back to every operation.
+ */
+typedef struct LockFreeLinkedList {
+  Node head; // A sentinel before the first node
+  atomic_int length;
+  _Alignas(64) _Atomic(unsigned long) epoch;
+  int maxThreads;
+  ThreadRecord *threads;
+} LockFreeLinkedList;
+
+/**
+ * Constructs a new lock-free linked list and returns a pointer to it. (Make
+ * sure to `destroy` the list once you're finished with it, after every thread
+ * has finished using it.)
+ *
+ * @param maxThreads The maximum number of threads that can be registered at
+ *   once.
+ */
+LockFreeLinkedList *newLockFreeLinkedList(int maxThreads) {
+  if (maxThreads < 1) {
+    printf("Error: maximum threads must be positive.\n");
+    return NULL;
+  }
+
+  LockFreeLinkedList *ptr = aligned_alloc(64, sizeof(LockFreeLinkedList));
+
+  ptr->head.element = NULL;
+  atomic_init(&ptr->head.next, 0);
+  atomic_init(&ptr->length, 0);
+  atomic_init(&ptr->epoch, 0);
+  ptr->maxThreads = maxThreads;
+  ptr->threads = aligned_alloc(64, maxThreads * sizeof(ThreadRecord));
+  for (int i = 0; i < maxThreads; i++) {
+    ThreadRecord *record = &ptr->threads[i];
+    atomic_init(&record->state, 0);
+    atomic_init(&record->inUse, false);
+    record->lastEpoch = 0;
+    record->retiredCount = 0;
+    record->limbo[0] = record->limbo[1] = record->limbo[2] = NULL;
+  }
+
+  return ptr;
+}
+
+/**
+ * Registers the calling thread with a lock-free linked list.
+ *
+ * @param list A pointer to the lock-free linked list.
+ * @return The thread's ID, or `-1` if the maximum number of threads is already
+ *   registered.
+ */
+int registerThread(LockFreeLinkedList *list) {
+  for (int i = 0; i < list->maxThreads; i++) {
+    bool expected = false;
+    if (atomic_compare_exchange_strong(&list->threads[i].inUse, &expected,
+                                       true))
+      return i;
+  }
+
+  printf("Error: lock-free linked list already has maximum threads.\n");
+  return -1;
+}
+
+/**
+ * Unregisters a thread from a lock-free linked list, freeing its ID for
+ * another thread. Nodes it has retired are freed once safe by whichever
+ * thread takes over its ID, or by `destroy`.
+ */
+void unregisterThread(LockFreeLinkedList *list, int thread) {
+  atomic_store(&list->threads[thread].inUse, false);
+}
+
+/** Frees every node in a limbo list. */
+static void freeLimbo(Node *node) {
+  while (node) {
+    Node *nextNode = node->retiredNext;
+    free(node);
+    node = nextNode;
+  }
+}
+
+/**
+ * Advances the global epoch if every pinned thread has already seen the
+ * current one.
+ */
+static void tryAdvance(LockFreeLinkedList *list) {
+  unsigned long epoch = atomic_load(&list->epoch);
+  for (int i = 0; i < list->maxThreads; i++) {
+    unsigned long state = atomic_load(&list->threads[i].state);
+    if ((state & 1) && state >> 1 != epoch)
+      return;
+  }
+
+  atomic_compare_exchange_strong(&list->epoch, &epoch, epoch + 1);
+}
+
+/**
+ * Pins a thread to the current epoch for the duration of an operation, first
+ * freeing the nodes it retired three or more epochs ago if the epoch has moved
+ * on.
+ */
+static void pin(LockFreeLinkedList *list, int thread) {
+  ThreadRecord *record = &list->threads[thread];
+  unsigned long epoch = atomic_load(&list->epoch);
+  atomic_store(&record->state, epoch << 1 | 1);
+
+  // Make the pin visible before reading any node
+  atomic_thread_fence(memory_order_seq_cst);
+
+  // Every pinned thread is now in this epoch or the one before, and may hold a
+  // node unlinked by a thread pinned one epoch earlier still, so only nodes
+  // retired in epochs up to `epoch - 3` are safe to free
+  unsigned long elapsed = epoch - record->lastEpoch;
+  for (unsigned long i = 1; i <= elapsed && i <= 3; i++) {
+    int bucket = (record->lastEpoch + i) % 3;
+    freeLimbo(record->limbo[bucket]);
+    record->limbo[bucket] = NULL;
+  }
+  record->lastEpoch = epoch;
+}
+
+/** Unpins a thread at the end of an operation. */
+static void unpin(LockFreeLinkedList *list, int thread) {
+  atomic_store_explicit(&list->threads[thread].state, 0,
+                        memory_order_release);
+}
+
+/**
+ * Hands a node that has just been unlinked over to be freed once no other
+ * thread can still be reading it.
+ */
+static void retire(LockFreeLinkedList *list, int thread, Node *node) {
+  ThreadRecord *record = &list->threads[thread];
+  int bucket = record->lastEpoch % 3;
+  node->retiredNext = record->limbo[bucket];
+  record->limbo[bucket] = node;
+
+  if (++record->retiredCount % RETIRE_THRESHOLD == 0)
+    tryAdvance(list);
+}
+
+/**
+ * Finds the first node whose element is not less than a given element,
+ * unlinking any marked nodes along the way.
+ *
+ * @param list A pointer to the lock-free linked list.
+ * @param thread The calling thread's ID.
+ * @param element The element to search for.
+ * @param previousNode A pointer that will receive the node before the one
+ *   found (possibly the head sentinel).
+ * @param currentNode A pointer that will receive the node found, or `NULL` if
+ *   every element is less than `element`.
+ * @return Whether or not the node found holds an element equal to `element`.
+ */
+static bool find(LockFreeLinkedList *list, int thread, const char *element,
+                 Node **previousNode, Node **currentNode) {
+retry:;
+  Node *previous = &list->head;
+  Node *current = pointer(atomic_load(&previous->next));
+  while (current) {
+    uintptr_t next = atomic_load(&current->next);
+    if (isMarked(next)) {
+      // Help finish removing the node, starting over if `previous` changed
+      uintptr_t expected = (uintptr_t)current;
+      if (!atomic_compare_exchange_strong(&previous->next, &expected,
+                                          (uintptr_t)pointer(next)))
+        goto retry;
+
+      retire(list, thread, current);
+      current = pointer(next);
+      continue;
+    }
+
+    int comparison = strcmp(current->element, element);
+    if (comparison >= 0) {
+      *previousNode = previous;
+      *currentNode = current;
+      return comparison == 0;
+    }
+
+    previous = current;
+    current = pointer(next);
+  }
+
+  *previousNode = previous;
+  *currentNode = NULL;
+  return false;
+}
+
+/** Returns the number of elements in a lock-free linked list. */
+int size(LockFreeLinkedList *list) { return atomic_load(&list->length); }
+
+/** Returns whether or not a lock-free linked list is empty. */
+bool isEmpty(LockFreeLinkedList *list) { return size(list) == 0; }
+
+/**
+ * Adds an element to a lock-free linked list in sorted order, unless an equal
+ * element is already there. Safe to call from any number of threads at once.
+ *
+ * @param list A pointer to the lock-free linked list.
+ * @param thread The calling thread's ID.
+ * @param element The element to be added.
+ * @return `0` if the element was added, `1` if it was already present.
+ */
+int add(LockFreeLinkedList *list, int thread, char *element) {
+  Node *node = newNode(element);
+  pin(list, thread);
+
+  while (true) {
+    Node *previous, *current;
+    if (find(list, thread, element, &previous, &current)) {
+      unpin(list, thread);
+      free(node);
+      return 1;
+    }
+
+    atomic_store_explicit(&node->next, (uintptr_t)current,
+                          memory_order_relaxed);
+    uintptr_t expected = (uintptr_t)current;
+    if (atomic_compare_exchange_strong(&previous->next, &expected,
+                                       (uintptr_t)node))
+      break;
+  }
+
+  atomic_fetch_add(&list->length, 1);
+  unpin(list, thread);
+  return 0;
+}
+
+/**
+ * Removes an element from a lock-free linked list (if possible). Safe to call
+ * from any number of threads at once.
+ *
+ * @param list A pointer to the lock-free linked list.
+ * @param thread The calling thread's ID.
+ * @param element The element to be removed.
+ * @return The number of occurrences removed.
+ */
+int removeOne(LockFreeLinkedList *list, int thread, char *element) {
+  pin(list, thread);
+
+  Node *previous, *current;
+  while (true) {
+    if (!find(list, thread, element, &previous, &current)) {
+      unpin(list, thread);
+      return 0;
+    }
+
+    // Logically remove the node by marking it, unless another thread got to
+    // it (or linked a node after it) first
+    uintptr_t next = atomic_load(&current->next);
+    if (!isMarked(next) &&
+        atomic_compare_exchange_strong(&current->next, &next, next | MARK))
+      break;
+  }
+  atomic_fetch_sub(&list->length, 1);
+
+  // Try to unlink it; if that fails, a search will finish the job
+  uintptr_t expected = (uintptr_t)current;
+  uintptr_t next = atomic_load(&current->next);
+  if (atomic_compare_exchange_strong(&previous->next, &expected,
+                                     (uintptr_t)pointer(next))) {
+    retire(list, thread, current);
+  } else {
+    find(list, thread, element, &previous, &current);
+  }
+
+  unpin(list, thread);
+  return 1;
+}
+
+/**
+ * Returns whether or not a lock-free linked list contains a given element.
+ * Safe to call from any number of threads at once, and never writes to the
+ * list itself.
+ */
+bool contains(LockFreeLinkedList *list, int thread, char *element) {
+  pin(list, thread);
+
+  Node *current = pointer(atomic_load(&list->head.next));
+  while (current && strcmp(current->element, element) < 0) {
+    current = pointer(atomic_load(&current->next));
+  }
+  bool found = current && strcmp(current->element, element) == 0 &&
+               !isMarked(atomic_load(&current->next));
+
+  unpin(list, thread);
+  return found;
+}
+
+/**
+ * Returns the numerical index of a given element in a lock-free linked list
+ * (or `-1` if the list does not contain this element). Only meaningful while
+ * no other thread is changing the list.
+ */
+int indexOf(LockFreeLinkedList *list, char *element) {
+  int index = 0;
+  Node *current = pointer(atomic_load(&list->head.next));
+  while (current) {
+    if (!isMarked(atomic_load(&current->next))) {
+      if (strcmp(current->element, element) == 0)
+        return index;
+      index++;
+    }
+    current = pointer(atomic_load(&current->next));
+  }
+
+  return -1;
+}
+
+/**
+ * Frees the allocated memory for a lock-free linked list and its contents.
+ * Every thread must have finished using the list.
+ */
+void destroy(LockFreeLinkedList *list) {
+  Node *current = pointer(atomic_load(&list->head.next));
+  while (current) {
+    Node *nextNode = pointer(atomic_load(&current->next));
+    free(current);
+    current = nextNode;
+  }
+
+  for (int i = 0; i < list->maxThreads; i++) {
+    for (int j = 0; j < 3; j++) {
+      freeLimbo(list->threads[i].limbo[j]);
+    }
+  }
+
+  free(list->threads);
+  free(list);
+}
+
+/**
+ * Prints the contents of a lock-free linked list to a console, separated by
+ * commas. Only meaningful while no other thread is changing the list.
+ */
+void print(LockFreeLinkedList *list) {
+  bool first = true;
+  Node *current = pointer(atomic_load(&list->head.next));
+  while (current) {
+    if (!isMarked(atomic_load(&current->next))) {
+      printf(first ? "\"%s\"" : ", \"%s\"", current->element);
+      first = false;
+    }
+    current = pointer(atomic_load(&current->next));
+  }
+  printf("\n");
+}
+
+#define NUM_THREADS 4
+#define KEYS_PER_THREAD 2000
+
+static LockFreeLinkedList *shared;
+static char keys[NUM_THREADS * KEYS_PER_THREAD][8];
+
+/**
+ * Repeatedly adds and removes this thread's own keys while checking for every
+ * key, so that threads interleave changes at neighboring nodes.
+ */
+static void *churn(void *arg) {
+  int worker = (int)(intptr_t)arg;
+  int thread = registerThread(shared);
+  assert(thread != -1);
+
+  unsigned seed = worker + 1;
+  for (int round = 0; round < 5; round++) {
+    for (int i = worker; i < NUM_THREADS * KEYS_PER_THREAD; i += NUM_THREADS) {
+      assert(add(shared, thread, keys[i]) == 0);
+      assert(contains(shared, thread, keys[i]));
+      contains(shared, thread, keys[rand_r(&seed) % (NUM_THREADS *
+                                                      KEYS_PER_THREAD)]);
+    }
+    for (int i = worker; i < NUM_THREADS * KEYS_PER_THREAD; i += NUM_THREADS) {
+      // Leave every other key in place after the last round
+      if (round < 4 || i / NUM_THREADS % 2 != 0) {
+        assert(removeOne(shared, thread, keys[i]) == 1);
+        assert(!contains(shared, thread, keys[i]));
+      }
+    }
+  }
+
+  unregisterThread(shared, thread);
+  return NULL;
+}
+
+static atomic_bool stopReading;
+
+/**
+ * Checks for random keys until told to stop, counting lookups. The count is
+ * kept locally and only stored once, so that readers' counters sharing a cache
+ * line don't slow each other down.
+ */
+static void *lookUp(void *arg) {
+  long long lookups = 0;
+  int thread = registerThread(shared);
+  unsigned seed = thread + 100;
+  while (!stopReading) {
+    contains(shared, thread, keys[rand_r(&seed) % (NUM_THREADS *
+                                                   KEYS_PER_THREAD)]);
+    lookups++;
+  }
+  *(long long *)arg = lookups;
+
+  unregisterThread(shared, thread);
+  return NULL;
+}
+
+static double secondsSince(struct timespec *start) {
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/** Measures lookup throughput with increasing numbers of reader threads. */
+static void benchmark(int maxReaders) {
+  shared = newLockFreeLinkedList(maxReaders + 1);
+  int writer = registerThread(shared);
+  for (int i = 0; i < NUM_THREADS * KEYS_PER_THREAD; i += 8) {
+    add(shared, writer, keys[i]);
+  }
+
+  for (int readers = 1; readers <= maxReaders; readers *= 2) {
+    pthread_t threads[readers];
+    long long lookups[readers];
+    stopReading = false;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int t = 0; t < readers; t++) {
+      lookups[t] = 0;
+      pthread_create(&threads[t], NULL, lookUp, &lookups[t]);
+    }
+    nanosleep(&(struct timespec){1, 0}, NULL);
+    stopReading = true;
+
+    long long total = 0;
+    for (int t = 0; t < readers; t++) {
+      pthread_join(threads[t], NULL);
+      total += lookups[t];
+    }
+    printf("%2d reader(s): %.2f million lookups/s\n", readers,
+           total / secondsSince(&start) / 1e6);
+  }
+
+  destroy(shared);
+}
+
+int main(int argc, char *argv[]) {
+  assert(newLockFreeLinkedList(0) == NULL);
+
+  LockFreeLinkedList *l = newLockFreeLinkedList(1);
+  int thread = registerThread(l);
+  assert(registerThread(l) == -1);
+
+  print(l);
+  assert(isEmpty(l));
+
+  // Elements are kept sorted, each at most once
+  assert(add(l, thread, "unicorn") == 0);
+  assert(add(l, thread, "hey") == 0);
+  assert(add(l, thread, "squirrel") == 0);
+  assert(add(l, thread, "hey") == 1);
+  assert(size(l) == 3);
+  print(l);
+
+  assert(indexOf(l, "hey") == 0);
+  assert(indexOf(l, "unicorn") == 2);
+  assert(indexOf(l, "boring") == -1);
+  assert(contains(l, thread, "squirrel"));
+  assert(!contains(l, thread, "boring"));
+
+  assert(removeOne(l, thread, "boring") == 0);
+  assert(removeOne(l, thread, "squirrel") == 1);
+  assert(removeOne(l, thread, "squirrel") == 0);
+  assert(!contains(l, thread, "squirrel"));
+  assert(size(l) == 2);
+
+  // Removed nodes are freed once the epoch has moved on three times
+  for (int i = 0; i < 10 * RETIRE_THRESHOLD; i++) {
+    add(l, thread, "opera");
+    removeOne(l, thread, "opera");
+  }
+  assert(atomic_load(&l->epoch) >= 3);
+
+  unregisterThread(l, thread);
+  destroy(l);
+
+  // Threads adding, removing and looking up neighboring keys at once
+  for (int i = 0; i < NUM_THREADS * KEYS_PER_THREAD; i++) {
+    snprintf(keys[i], sizeof(keys[i]), "%05d", i);
+  }
+  shared = newLockFreeLinkedList(NUM_THREADS + 1);
+  pthread_t threads[NUM_THREADS];
+  long long lookups = 0;
+  pthread_t reader;
+  stopReading = false;
+  pthread_create(&reader, NULL, lookUp, &lookups);
+  for (int t = 0; t < NUM_THREADS; t++) {
+    pthread_create(&threads[t], NULL, churn, (void *)(intptr_t)t);
+  }
+  for (int t = 0; t < NUM_THREADS; t++) {
+    pthread_join(threads[t], NULL);
+  }
+  stopReading = true;
+  pthread_join(reader, NULL);
+
+  // Every other key of every thread is left, in order
+  assert(size(shared) == NUM_THREADS * KEYS_PER_THREAD / 2);
+  for (int i = 0; i < NUM_THREADS * KEYS_PER_THREAD; i++) {
+    bool kept = i / NUM_THREADS % 2 == 0;
+    assert((indexOf(shared, keys[i]) != -1) == kept);
+  }
+  int previous = -1;
+  for (Node *node = pointer(shared->head.next); node;
+       node = pointer(node->next)) {
+    assert(!isMarked(node->next));
+    assert(atoi(node->element) > previous);
+    previous = atoi(node->element);
+  }
+
+  destroy(shared);
+  printf("All tests passed successfully.\n");
+
+  // Pass `bench [maximum readers]` to measure how lookups scale
+  if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    benchmark(argc > 2 ? atoi(argv[2]) : 8);
+
+  return 0;
+}
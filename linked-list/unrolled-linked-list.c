@@ -0,0 +1,545 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/** The size of a cache line, and so of every node. */
+#define CACHE_LINE 64
+
+/** The number of elements that fit in a node alongside its header. */
+#define NODE_CAPACITY                                                          \
+  ((int)((CACHE_LINE - 2 * sizeof(void *)) / sizeof(char *)))
+
+typedef struct Node {
+  struct Node *next;
+  int count;
+  char *elements[NODE_CAPACITY];
+} Node;
+
+_Static_assert(sizeof(Node) == CACHE_LINE, "a node must fill one cache line");
+
+static Node *newNode() {
+  Node *ptr = aligned_alloc(CACHE_LINE, sizeof(Node));
+
+  ptr->next = NULL;
+  ptr->count = 0;
+
+  return ptr;
+}
+
+/*
+ * An unrolled linked list data structure, where each node holds up to
+ * `NODE_CAPACITY` elements in an array and a reference to the node after it.
+ * Every node fills exactly one cache line, so a sequential scan touches one
+ * cache line per several elements rather than one (plus a separate
+ * allocation) per element. Every node but the last is kept at least half
+ * full: inserting into a full node splits it in two, and removing from a node
+ * that falls below half full merges it with (or borrows from) the next node.
+ */
+typedef struct UnrolledLinkedList {
+  int length;
+  Node *head;
+  Node *tail;
+} UnrolledLinkedList;
+
+UnrolledLinkedList *newUnrolledLinkedList() {
+  UnrolledLinkedList *ptr = malloc(sizeof(UnrolledLinkedList));
+
+  ptr->length = 0;
+  ptr->head = NULL;
+  ptr->tail = NULL;
+
+  return ptr;
+}
+
+/** Returns the number of elements in an unrolled linked list. */
+int size(UnrolledLinkedList *list) { return list->length; }
+
+/** Returns whether or not an unrolled linked list is empty. */
+bool isEmpty(UnrolledLinkedList *list) { return size(list) == 0; }
+
+/**
+ * Inserts an element into a node at a given offset, first splitting the node
+ * in two if it is full.
+ */
+static void insertIntoNode(UnrolledLinkedList *list, Node *node, int offset,
+                           char *element) {
+  if (node->count == NODE_CAPACITY) {
+    // Move the upper half of the elements into a new node after this one
+    int half = NODE_CAPACITY / 2;
+    Node *sibling = newNode();
+    sibling->count = NODE_CAPACITY - half;
+    memcpy(sibling->elements, node->elements + half,
+           sibling->count * sizeof(char *));
+    node->count = half;
+
+    sibling->next = node->next;
+    node->next = sibling;
+    if (list->tail == node)
+      list->tail = sibling;
+
+    if (offset > half) {
+      node = sibling;
+      offset -= half;
+    }
+  }
+
+  memmove(node->elements + offset + 1, node->elements + offset,
+          (node->count - offset) * sizeof(char *));
+  node->elements[offset] = element;
+  node->count++;
+  list->length++;
+}
+
+/**
+ * Removes the element at a given offset from a node, then merges the node
+ * with the next one (or borrows an element from it) if it is less than half
+ * full, or unlinks it if it is left empty.
+ *
+ * @return Whether or not the node was freed.
+ */
+static bool removeFromNode(UnrolledLinkedList *list, Node *previousNode,
+                           Node *node, int offset) {
+  memmove(node->elements + offset, node->elements + offset + 1,
+          (node->count - offset - 1) * sizeof(char *));
+  node->count--;
+  list->length--;
+
+  Node *nextNode = node->next;
+  if (node->count < NODE_CAPACITY / 2 && nextNode) {
+    if (node->count + nextNode->count <= NODE_CAPACITY) {
+      // Merge the next node into this one
+      memcpy(node->elements + node->count, nextNode->elements,
+             nextNode->count * sizeof(char *));
+      node->count += nextNode->count;
+      node->next = nextNode->next;
+      if (list->tail == nextNode)
+        list->tail = node;
+      free(nextNode);
+    } else {
+      // Borrow the next node's first element
+      node->elements[node->count++] = nextNode->elements[0];
+      nextNode->count--;
+      memmove(nextNode->elements, nextNode->elements + 1,
+              nextNode->count * sizeof(char *));
+    }
+  }
+
+  // Only the last node can be left empty, since any other would have merged
+  if (node->count == 0) {
+    if (previousNode) {
+      previousNode->next = NULL;
+    } else {
+      list->head = NULL;
+    }
+    list->tail = previousNode;
+    free(node);
+    return true;
+  }
+
+  return false;
+}
+
+/**
+ * Finds the node holding the element at a given index in an unrolled linked
+ * list, which must be in bounds.
+ *
+ * @param list A pointer to the unrolled linked list.
+ * @param index The index of the element.
+ * @param previousNode A pointer that will receive the node before the one
+ *   found (or `NULL` if it is the head).
+ * @param offset A pointer that will receive the element's offset in the node.
+ * @return The node holding the element.
+ */
+static Node *findNode(UnrolledLinkedList *list, int index, Node **previousNode,
+                      int *offset) {
+  *previousNode = NULL;
+  Node *currentNode = list->head;
+  while (index >= currentNode->count) {
+    index -= currentNode->count;
+    *previousNode = currentNode;
+    currentNode = currentNode->next;
+  }
+
+  *offset = index;
+  return currentNode;
+}
+
+/**
+ * Adds a new element to the end of an unrolled linked list.
+ *
+ * @param list A pointer to the unrolled linked list.
+ * @param element The element to be added.
+ */
+void add(UnrolledLinkedList *list, char *element) {
+  // Start a new node rather than splitting a full tail, so that a list built
+  // by appending is packed full
+  if (!list->tail || list->tail->count == NODE_CAPACITY) {
+    Node *node = newNode();
+    if (list->tail) {
+      list->tail->next = node;
+    } else {
+      list->head = node;
+    }
+    list->tail = node;
+  }
+
+  list->tail->elements[list->tail->count++] = element;
+  list->length++;
+}
+
+/**
+ * Adds a new element to the start of an unrolled linked list.
+ *
+ * @param list A pointer to the unrolled linked list.
+ * @param element The element to be added.
+ */
+void prepend(UnrolledLinkedList *list, char *element) {
+  if (isEmpty(list)) {
+    add(list, element);
+  } else {
+    insertIntoNode(list, list->head, 0, element);
+  }
+}
+
+/**
+ * Removes the first occurrence of a given element from an unrolled linked list
+ * (if possible).
+ *
+ * @param list A pointer to the unrolled linked list.
+ * @param element The element to be removed.
+ * @return The number of occurrences removed.
+ */
+int removeOne(UnrolledLinkedList *list, char *element) {
+  Node *previousNode = NULL;
+  for (Node *node = list->head; node; node = node->next) {
+    for (int i = 0; i < node->count; i++) {
+      if (node->elements[i] == element) {
+        removeFromNode(list, previousNode, node, i);
+        return 1;
+      }
+    }
+    previousNode = node;
+  }
+
+  // Element wasn't found
+  return 0;
+}
+
+/**
+ * Removes all occurrences of a given element from an unrolled linked list.
+ *
+ * @param list A pointer to the unrolled linked list.
+ * @param element The element to be removed.
+ * @return The number of occurrences removed.
+ */
+int removeAll(UnrolledLinkedList *list, char *element) {
+  int oldLength = list->length;
+
+  Node *previousNode = NULL;
+  Node *node = list->head;
+  while (node) {
+    // Removing shifts the following elements (possibly from the next node)
+    // into place, so only move on when nothing was removed
+    int i = 0;
+    while (i < node->count) {
+      if (node->elements[i] != element) {
+        i++;
+      } else if (removeFromNode(list, previousNode, node, i)) {
+        return oldLength - list->length;
+      }
+    }
+
+    previousNode = node;
+    node = node->next;
+  }
+
+  return oldLength - list->length;
+}
+
+/**
+ * Returns the numerical index of the first occurrence of a given element in an
+ * unrolled linked list (or `-1` if the list does not contain this element).
+ */
+int indexOf(UnrolledLinkedList *list, char *element) {
+  int index = 0;
+  for (Node *node = list->head; node; node = node->next) {
+    for (int i = 0; i < node->count; i++) {
+      if (node->elements[i] == element) {
+        return index + i;
+      }
+    }
+    index += node->count;
+  }
+
+  return -1;
+}
+
+/**
+ * Returns the element at a given index in an unrolled linked list (or `NULL`
+ * if the list has no such index).
+ */
+char *elementAt(UnrolledLinkedList *list, int index) {
+  if (index < 0 || index >= list->length) {
+    return NULL;
+  }
+
+  Node *previousNode;
+  int offset;
+  Node *node = findNode(list, index, &previousNode, &offset);
+  return node->elements[offset];
+}
+
+/**
+ * Removes and returns the element at a given index from an unrolled linked
+ * list (or returns `NULL` if the list has no such index).
+ */
+char *removeAt(UnrolledLinkedList *list, int index) {
+  if (index < 0 || index >= list->length) {
+    return NULL;
+  }
+
+  Node *previousNode;
+  int offset;
+  Node *node = findNode(list, index, &previousNode, &offset);
+
+  char *removedElement = node->elements[offset];
+  removeFromNode(list, previousNode, node, offset);
+  return removedElement;
+}
+
+/**
+ * Inserts a given element at a given index in an unrolled linked list.
+ *
+ * @param list A pointer to the unrolled linked list.
+ * @param index The index at which to insert the element.
+ * @param element The element to be inserted.
+ * @return `0` if the element was successfully inserted, `1` if given an invalid
+ *   index.
+ */
+int insertAt(UnrolledLinkedList *list, int index, char *element) {
+  if (index < 0 || index > list->length) {
+    return 1;
+  }
+
+  if (index == list->length) {
+    add(list, element);
+  } else {
+    Node *previousNode;
+    int offset;
+    Node *node = findNode(list, index, &previousNode, &offset);
+    insertIntoNode(list, node, offset, element);
+  }
+
+  return 0;
+}
+
+/** Clears the contents of an unrolled linked list. */
+void clear(UnrolledLinkedList *list) {
+  // Free allocated memory
+  Node *currentNode = list->head;
+  while (currentNode) {
+    Node *nextNode = currentNode->next;
+    free(currentNode);
+    currentNode = nextNode;
+  }
+
+  list->head = NULL;
+  list->tail = NULL;
+  list->length = 0;
+}
+
+/** Frees the allocated memory for an unrolled linked list and its contents. */
+void destroy(UnrolledLinkedList *list) {
+  clear(list);
+  free(list);
+}
+
+/**
+ * Prints the contents of an unrolled linked list to a console, separated by
+ * commas.
+ */
+void print(UnrolledLinkedList *list) {
+  bool first = true;
+  for (Node *node = list->head; node; node = node->next) {
+    for (int i = 0; i < node->count; i++) {
+      printf(first ? "\"%s\"" : ", \"%s\"", node->elements[i]);
+      first = false;
+    }
+  }
+  printf("\n");
+}
+
+/** Checks that every node but the last is at least half full. */
+static bool isBalanced(UnrolledLinkedList *list) {
+  int length = 0;
+  for (Node *node = list->head; node; node = node->next) {
+    if (node->count == 0 || (node->next && node->count < NODE_CAPACITY / 2))
+      return false;
+    if (!node->next && node != list->tail)
+      return false;
+    length += node->count;
+  }
+
+  return length == list->length;
+}
+
+/** A node of a plain linked list, as in linked-list.c, for benchmarking. */
+typedef struct PlainNode {
+  char *element;
+  struct PlainNode *next;
+} PlainNode;
+
+static double secondsSince(struct timespec *start) {
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * Scans `n` elements for a missing element, once through a plain linked list
+ * and once through an unrolled linked list, each built by appending.
+ */
+static void benchmark(int n) {
+  char *missing = "missing";
+  char *present = "present";
+  struct timespec start;
+  int scans = 20;
+
+  PlainNode *head = NULL, **last = &head;
+  for (int i = 0; i < n; i++) {
+    PlainNode *node = malloc(sizeof(PlainNode));
+    node->element = present;
+    node->next = NULL;
+    *last = node;
+    last = &node->next;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  int found = 0;
+  for (int s = 0; s < scans; s++) {
+    for (PlainNode *node = head; node; node = node->next) {
+      found += node->element == missing;
+    }
+  }
+  printf("plain linked list scan:    %.3fs\n", secondsSince(&start));
+  while (head) {
+    PlainNode *next = head->next;
+    free(head);
+    head = next;
+  }
+
+  UnrolledLinkedList *list = newUnrolledLinkedList();
+  for (int i = 0; i < n; i++) {
+    add(list, present);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int s = 0; s < scans; s++) {
+    found += indexOf(list, missing) != -1;
+  }
+  printf("unrolled linked list scan: %.3fs\n", secondsSince(&start));
+  assert(found == 0);
+
+  destroy(list);
+}
+
+int main(int argc, char *argv[]) {
+  UnrolledLinkedList *l = newUnrolledLinkedList();
+
+  print(l);
+  assert(isEmpty(l));
+
+  add(l, "hey");
+  add(l, "unicorn");
+  assert(size(l) == 2);
+  print(l);
+
+  add(l, "squirrel");
+  add(l, "opera");
+  assert(insertAt(l, 2, "gait") == 0);
+  assert(indexOf(l, "squirrel") == 3);
+
+  assert(removeOne(l, "boring") == 0);
+  add(l, "unicorn");
+  assert(removeAll(l, "unicorn") == 2);
+
+  assert(strcmp(elementAt(l, 1), "gait") == 0);
+  assert(strcmp(removeAt(l, 0), "hey") == 0);
+  assert(size(l) == 3);
+  assert(!isEmpty(l));
+
+  print(l);
+
+  clear(l);
+  assert(isEmpty(l));
+
+  // Nodes split and merge while staying in step with an array of indices
+  char names[200][8];
+  char *mirror[200];
+  int mirrorLength = 0;
+  for (int i = 0; i < 200; i++) {
+    snprintf(names[i], sizeof(names[i]), "%d", i);
+  }
+  for (int step = 0; step < 20000; step++) {
+    int action = rand() % 3;
+    if (mirrorLength < 200 && (action < 2 || mirrorLength == 0)) {
+      int index = rand() % (mirrorLength + 1);
+      char *element = names[rand() % 200];
+      if (index == 0 && rand() % 2) {
+        prepend(l, element);
+      } else {
+        assert(insertAt(l, index, element) == 0);
+      }
+      memmove(mirror + index + 1, mirror + index,
+              (mirrorLength - index) * sizeof(char *));
+      mirror[index] = element;
+      mirrorLength++;
+    } else {
+      int index = rand() % mirrorLength;
+      assert(removeAt(l, index) == mirror[index]);
+      memmove(mirror + index, mirror + index + 1,
+              (mirrorLength - index - 1) * sizeof(char *));
+      mirrorLength--;
+    }
+
+    assert(size(l) == mirrorLength);
+    assert(isBalanced(l));
+  }
+  for (int i = 0; i < mirrorLength; i++) {
+    assert(elementAt(l, i) == mirror[i]);
+  }
+
+  // Removing every occurrence keeps the nodes balanced
+  char *common = names[7];
+  for (int i = 0; i < 100; i++) {
+    assert(insertAt(l, rand() % (size(l) + 1), common) == 0);
+  }
+  int occurrences = 0;
+  for (int i = 0; i < size(l); i++) {
+    occurrences += elementAt(l, i) == common;
+  }
+  assert(removeAll(l, common) == occurrences);
+  assert(indexOf(l, common) == -1);
+  assert(isBalanced(l));
+
+  // Removing everything frees every node
+  while (!isEmpty(l)) {
+    removeOne(l, elementAt(l, 0));
+    assert(isBalanced(l));
+  }
+  assert(l->head == NULL && l->tail == NULL);
+  add(l, "x");
+  add(l, "x");
+  assert(removeAll(l, "x") == 2);
+  assert(l->head == NULL);
+
+  destroy(l);
+  printf("All tests passed successfully.\n");
+
+  // Pass `bench [number of elements]` to compare scans with a plain list
+  if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    benchmark(argc > 2 ? atoi(argv[2]) : 1000000);
+
+  return 0;
+}
@@ -3,6 +3,11 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#include "../generic-heap/generic-heap.h"
+
+#define GREATER_THAN(a, b) ((a) > (b))
 
 /**
  * A binary max heap implemented as an implicit data structure. Keys are stored
@@ -11,39 +16,45 @@
  * will be located at `2 * i + 1` and `2 * i + 2`, and its parent will be
  * located at `(i - 1) / 2` (using integer division). All parent nodes will be
  * greater than or equal to their child nodes.
+ *
+ * The heap is generated by `DEFINE_HEAP`, and the functions below are thin
+ * wrappers over it. Construct one with `newMaxHeap(maxSize)` (and `destroy` it
+ * once you're finished with it): its internal array starts small and grows
+ * geometrically as values are added, so `maxSize` only caps the heap's size
+ * rather than being allocated up front. Pass `INT_MAX` for no practical limit.
  */
-typedef struct MaxHeap {
-  int maxSize;
-  int length;
-  int array[];
-} MaxHeap;
+DEFINE_HEAP(MaxHeap, int, GREATER_THAN)
 
-/**
- * Constructs a new instance of a max heap and returns a pointer to it. (Make
- * sure to `free` the pointer once you're finished with it.)
- */
-MaxHeap *newMaxHeap(int maxSize) {
-  if (maxSize < 1) {
-    printf("Error: maximum size must be positive.\n");
-    return NULL;
-  }
+/** Returns the number of values in a max heap. */
+int length(MaxHeap *heap) { return MaxHeapLength(heap); }
 
-  MaxHeap *ptr = malloc(sizeof(MaxHeap) + maxSize * sizeof(int));
+/** Returns whether or not a max heap is empty. */
+bool isEmpty(MaxHeap *heap) { return MaxHeapIsEmpty(heap); }
 
-  ptr->maxSize = maxSize;
-  ptr->length = 0;
+/** Returns whether or not a max heap is full. */
+bool isFull(MaxHeap *heap) { return MaxHeapIsFull(heap); }
 
-  return ptr;
+/**
+ * Makes sure a max heap's internal array has room for at least a given number
+ * of values, so that adding up to that many values won't reallocate it.
+ *
+ * @param heap A pointer to the max heap.
+ * @param capacity The number of values to make room for.
+ * @return `0` if there is now enough room, `1` if `capacity` exceeds the heap's
+ *   maximum size or memory couldn't be allocated.
+ */
+int reserve(MaxHeap *heap, int capacity) {
+  return MaxHeapReserve(heap, capacity);
 }
 
-/** Returns the number of values in a max heap. */
-int length(MaxHeap *heap) { return heap->length; }
-
-/** Returns whether or not a max heap is empty. */
-bool isEmpty(MaxHeap *heap) { return length(heap) == 0; }
+/**
+ * Shrinks a max heap's internal array to fit the values it currently holds,
+ * returning unused memory after a burst of values has drained.
+ */
+void shrinkToFit(MaxHeap *heap) { MaxHeapShrinkToFit(heap); }
 
-/** Returns whether or not a max heap is full. */
-bool isFull(MaxHeap *heap) { return length(heap) == heap->maxSize; }
+/** Frees the allocated memory for a max heap. */
+void destroy(MaxHeap *heap) { MaxHeapDestroy(heap); }
 
 /**
  * Adds a value to a max heap, maintaining the heap property.
@@ -53,25 +64,36 @@ bool isFull(MaxHeap *heap) { return length(heap) == heap->maxSize; }
  * @return `0` if the value was successfully added, `1` if the max heap was
  *   already at maximum capacity (stack overflow).
  */
-int push(MaxHeap *heap, int value) {
-  if (isFull(heap)) {
-    printf("Error: stack overflow: heap is already at maximum capacity\n");
-    return 1;
-  }
-
-  int currentIndex = heap->length;
-  int parentIndex = (currentIndex - 1) / 2;
-  while (currentIndex > 0 && value > heap->array[parentIndex]) {
-    // Switch with parent
-    heap->array[currentIndex] = heap->array[parentIndex];
-    currentIndex = parentIndex;
+int push(MaxHeap *heap, int value) { return MaxHeapPush(heap, value); }
 
-    parentIndex = (currentIndex - 1) / 2;
-  }
+/**
+ * Constructs a new instance of a max heap holding a copy of the values in an
+ * array, and returns a pointer to it. (Make sure to `destroy` the heap once
+ * you're finished with it.)
+ *
+ * @param values A pointer to the first value to copy.
+ * @param length The number of values to copy.
+ * @param maxSize The maximum size of the heap, which must be at least
+ *   `length`.
+ * @return A pointer to the max heap, or `NULL` if `maxSize` was too small.
+ */
+MaxHeap *newMaxHeapFromArray(int *values, int length, int maxSize) {
+  return MaxHeapFromArray(values, length, maxSize);
+}
 
-  heap->array[currentIndex] = value;
-  heap->length++;
-  return 0;
+/**
+ * Adds several values to a max heap, maintaining the heap property. Large
+ * batches are appended all at once and the heap is rebuilt, which is cheaper
+ * than pushing them one by one.
+ *
+ * @param heap A pointer to the max heap.
+ * @param values A pointer to the first value to add.
+ * @param count The number of values to add.
+ * @return `0` if the values were successfully added, `1` if the max heap didn't
+ *   have room for all of them (in which case none are added).
+ */
+int pushMany(MaxHeap *heap, int *values, int count) {
+  return MaxHeapPushMany(heap, values, count);
 }
 
 /**
@@ -80,50 +102,18 @@ int push(MaxHeap *heap, int value) {
  *
  * @param heap A pointer to the max heap.
  * @return A pointer to an integer denoting the value removed, or `NULL` if the
- *   max heap was already empty.
+ *   max heap was already empty. The pointer is into the heap's own array, so
+ *   it is only valid until the next call that adds values or resizes the array
+ *   (`push`, `pushMany`, `reserve` or `shrinkToFit`).
  */
 int *pop(MaxHeap *heap) {
-  if (isEmpty(heap))
+  int max;
+  if (MaxHeapPop(heap, &max))
     return NULL;
 
-  // Save return value
-  int max = heap->array[0];
-
-  heap->length--;
-
-  if (heap->length == 0) {
-    int *ptr = &max;
-    return ptr;
-  }
-
-  // Rebalance the heap by moving the last element into the root position, then
-  // continuing to swap it with its greatest-valued child until it is greater
-  // than both children or it reaches the last level of the tree
-  int currentIdx = 0;
-  int child1Idx = 2 * currentIdx + 1;
-  int child2Idx = 2 * currentIdx + 2;
-  int value = heap->array[heap->length];
-  while ((child1Idx < heap->length && value < heap->array[child1Idx]) ||
-         (child2Idx < heap->length && value < heap->array[child2Idx])) {
-    if (child2Idx >= heap->length ||
-        heap->array[child1Idx] > heap->array[child2Idx]) {
-      // Swap with child 1
-      heap->array[currentIdx] = heap->array[child1Idx];
-      currentIdx = child1Idx;
-    } else {
-      // Swap with child 2
-      heap->array[currentIdx] = heap->array[child2Idx];
-      currentIdx = child2Idx;
-    }
-
-    child1Idx = 2 * currentIdx + 1;
-    child2Idx = 2 * currentIdx + 2;
-  }
-
-  heap->array[currentIdx] = value;
-
-  int *ptr = &max;
-  return ptr;
+  // Keep the removed value in the slot the heap just gave up
+  heap->array[heap->length] = max;
+  return &heap->array[heap->length];
 }
 
 /**
@@ -132,63 +122,38 @@ int *pop(MaxHeap *heap) {
  *
  * @param heap A pointer to the max heap.
  * @return `NULL` if the heap is currently empty; otherwise, a pointer to the
- *   first element of the array of values. Take care not to attempt to access
- *   array members at indices of `heap->length` or greater, as this will produce
- *   garbage values.
+ *   heap's own internal array, valid until the heap is next modified. Take
+ *   care not to attempt to access array members at indices of `heap->length`
+ *   or greater, as this will produce garbage values.
  */
 int *print(MaxHeap *heap) {
   if (isEmpty(heap))
     return NULL;
 
-  int array[heap->length];
-  for (int i = 0; i < heap->length; i++) {
-    array[i] = heap->array[i];
-  }
-
-  int *ptr = array;
-  return ptr;
+  return heap->array;
 }
 
 /** Clears the contents of a max heap. */
-void clear(MaxHeap *heap) { heap->length = 0; }
-
-/** Creates a deep clone of a max heap. */
-MaxHeap *clone(MaxHeap *original) {
-  MaxHeap *clone = newMaxHeap(original->maxSize);
-  clone->length = original->length;
-  for (int i = 0; i < original->length; i++) {
-    clone->array[i] = original->array[i];
-  }
+void clear(MaxHeap *heap) { MaxHeapClear(heap); }
 
-  return clone;
-}
+/**
+ * Creates a deep clone of a max heap.
+ *
+ * @return A pointer to the clone, or `NULL` if memory couldn't be allocated.
+ */
+MaxHeap *clone(MaxHeap *original) { return MaxHeapClone(original); }
 
 /**
- * Returns a pointer to an array of all values in a max heap ordered from
- * greatest to least.
+ * Writes all values in a max heap into a caller-supplied buffer, ordered from
+ * greatest to least, leaving the heap unchanged. The copy is sorted in place
+ * with heapsort, so no memory is allocated.
  *
  * @param heap A pointer to the max heap.
- * @return `NULL` if the heap is currently empty; otherwise, a pointer to the
- *   first element of the array of values. Take care not to attempt to access
- *   array members at indices of `heap->length` or greater, as this will produce
- *   garbage values.
+ * @param buffer A pointer to an array with room for at least `heap->length`
+ *   values.
+ * @return The number of values written.
  */
-int *sort(MaxHeap *heap) {
-  if (isEmpty(heap))
-    return NULL;
-
-  MaxHeap *copy = clone(heap);
-
-  int sorted[heap->length];
-  for (int i = 0; i < heap->length; i++) {
-    sorted[i] = *pop(copy);
-  }
-
-  free(copy);
-
-  int *ptr = sorted;
-  return ptr;
-}
+int sort(MaxHeap *heap, int *buffer) { return MaxHeapSort(heap, buffer); }
 
 int main() {
   MaxHeap *h = newMaxHeap(10);
@@ -227,7 +192,8 @@ int main() {
     assert(unsorted[i] <= unsorted[(i - 1) / 2]);
   }
 
-  int *sorted = sort(h);
+  int sorted[10];
+  assert(sort(h, sorted) == 10);
   assert(sorted[0] == maxValue);
   // Test sorting
   for (int i = 1; i < 10; i++) {
@@ -242,9 +208,63 @@ int main() {
   assert(length(h) == 0);
   assert(isEmpty(h));
   assert(print(h) == NULL);
-  assert(sort(h) == NULL);
+  assert(sort(h, sorted) == 0);
+
+  destroy(h);
+
+  // Building from an array and adding batches keep the heap property
+  int values[1000];
+  for (int i = 0; i < 1000; i++) {
+    values[i] = rand() % 1000;
+  }
+  assert(newMaxHeapFromArray(values, 10, 5) == NULL);
+  h = newMaxHeapFromArray(values, 100, 1000);
+  assert(length(h) == 100);
+  assert(pushMany(h, values + 100, 5) == 0);
+  assert(pushMany(h, values + 105, 895) == 0);
+  assert(isFull(h));
+  assert(pushMany(h, values, 1) == 1);
+  for (int i = 1; i < 1000; i++) {
+    assert(h->array[i] <= h->array[(i - 1) / 2]);
+  }
+  int previous = *pop(h);
+  while (!isEmpty(h)) {
+    int value = *pop(h);
+    assert(value <= previous);
+    previous = value;
+  }
+
+  destroy(h);
 
-  free(h);
+  // Heaps grow on demand up to their maximum size, and shrink back on request
+  h = newMaxHeap(INT_MAX);
+  assert(h->capacity == HEAP_INITIAL_CAPACITY);
+  for (int i = 0; i < 100000; i++) {
+    assert(push(h, values[i % 1000]) == 0);
+  }
+  assert(h->capacity >= 100000 && h->capacity < 200000);
+  for (int i = 1; i < 100000; i++) {
+    assert(h->array[i] <= h->array[(i - 1) / 2]);
+  }
+  while (length(h) > 10) {
+    pop(h);
+  }
+  shrinkToFit(h);
+  assert(h->capacity == 10);
+  MaxHeap *copy = clone(h);
+  assert(copy->length == 10 && copy->maxSize == INT_MAX);
+  assert(memcmp(copy->array, h->array, 10 * sizeof(int)) == 0);
+  destroy(copy);
+  assert(reserve(h, 50) == 0);
+  assert(h->capacity == 50);
+  destroy(h);
+
+  h = newMaxHeap(20);
+  assert(reserve(h, 21) == 1);
+  assert(pushMany(h, values, 20) == 0);
+  assert(h->capacity == 20);
+  assert(isFull(h));
+  destroy(h);
   printf("All tests passed successfully.\n");
 
   return 0;
@@ -0,0 +1,667 @@
+#include <assert.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+/** The number of values each run reads from (or writes to) disk at a time. */
+#define RUN_BUFFER_SIZE 1024
+
+/** The number of runs of the same level that are merged into one. */
+#define FAN_IN 8
+
+/**
+ * A sorted run of values spilled to a temporary file, read back sequentially
+ * through an in-memory buffer. Runs are merged in levels: a level `0` run is
+ * spilled straight from memory, and a level `l + 1` run is the merger of
+ * `FAN_IN` runs of level `l`.
+ */
+typedef struct Run {
+  FILE *file;
+  long long remaining; // Values still on disk, not yet read into the buffer
+  int bufferLength;
+  int bufferPos;
+  int level;
+  int buffer[RUN_BUFFER_SIZE];
+} Run;
+
+/**
+ * An external-memory min heap for holding more values than fit in memory. New
+ * values go into an in-memory binary min heap of at most `memoryBudget`
+ * values; once it fills up, its values are sorted and spilled to disk as a
+ * run. Popping takes the lesser of the in-memory heap's root and the least
+ * head of all runs, which are themselves kept in a binary min heap keyed by
+ * their heads.
+ *
+ * Whenever `FAN_IN` runs of the same level pile up, they are merged into a
+ * single run of the next level, so there are never more than `FAN_IN - 1`
+ * runs per level and every value is rewritten only O(log(n / memoryBudget))
+ * times. All disk I/O is sequential and done `RUN_BUFFER_SIZE` values at a
+ * time. Besides the in-memory heap, each run holds one buffer in memory.
+ *
+ * A failed read or write never loses a value: the operation that hit it
+ * returns `1` and leaves every value already held where it was.
+ */
+typedef struct ExternalMinHeap {
+  int memoryBudget;
+  long long length;
+  int heapLength; // Values in the in-memory heap
+  int *heap;
+  int numRuns;
+  int runCapacity;
+  Run **runs;    // Ordered from highest level to lowest
+  Run **runHeap; // The same runs, as a min heap keyed by their heads
+} ExternalMinHeap;
+
+/**
+ * Constructs a new instance of an external-memory min heap and returns a
+ * pointer to it. (Make sure to `destroy` the heap once you're finished with
+ * it.)
+ *
+ * @param memoryBudget The number of values to hold in memory before spilling
+ *   them to disk.
+ */
+ExternalMinHeap *newExternalMinHeap(int memoryBudget) {
+  if (memoryBudget < 1) {
+    printf("Error: memory budget must be positive.\n");
+    return NULL;
+  }
+
+  ExternalMinHeap *ptr = malloc(sizeof(ExternalMinHeap));
+
+  ptr->memoryBudget = memoryBudget;
+  ptr->length = 0;
+  ptr->heapLength = 0;
+  ptr->heap = malloc(memoryBudget * sizeof(int));
+  ptr->numRuns = 0;
+  ptr->runCapacity = FAN_IN;
+  ptr->runs = malloc(ptr->runCapacity * sizeof(Run *));
+  ptr->runHeap = malloc(ptr->runCapacity * sizeof(Run *));
+
+  return ptr;
+}
+
+/** Returns the number of values in an external-memory min heap. */
+long long length(ExternalMinHeap *heap) { return heap->length; }
+
+/** Returns whether or not an external-memory min heap is empty. */
+bool isEmpty(ExternalMinHeap *heap) { return length(heap) == 0; }
+
+/** Returns whether or not every value of a run has been consumed. */
+static bool isExhausted(Run *run) {
+  return run->bufferPos == run->bufferLength && run->remaining == 0;
+}
+
+/**
+ * Reads a run's next block from disk into its buffer. If the read fails, the
+ * file is moved back to where it was, so the read can be tried again.
+ *
+ * @return `0` if the block was read, `1` if it couldn't be.
+ */
+static int readBlock(Run *run) {
+  int count =
+      run->remaining < RUN_BUFFER_SIZE ? (int)run->remaining : RUN_BUFFER_SIZE;
+  fpos_t position;
+  if (fgetpos(run->file, &position) ||
+      fread(run->buffer, sizeof(int), count, run->file) != (size_t)count) {
+    printf("Error: failed to read a spilled run back from disk.\n");
+    clearerr(run->file);
+    fsetpos(run->file, &position);
+    return 1;
+  }
+
+  run->remaining -= count;
+  run->bufferLength = count;
+  run->bufferPos = 0;
+  return 0;
+}
+
+/** Returns the least unread value of a run that isn't exhausted. */
+static int head(Run *run) { return run->buffer[run->bufferPos]; }
+
+/**
+ * Consumes the head of a run, reading the next block from disk if the buffer
+ * runs out.
+ *
+ * @return `0` if the head was consumed, `1` if the next block couldn't be
+ *   read, in which case the run is left as it was.
+ */
+static int consumeHead(Run *run) {
+  run->bufferPos++;
+  if (run->bufferPos < run->bufferLength || run->remaining == 0)
+    return 0;
+
+  int value = run->buffer[run->bufferPos - 1];
+  if (readBlock(run)) {
+    // The failed read may have overwritten the head, so put it back
+    run->bufferPos--;
+    run->buffer[run->bufferPos] = value;
+    return 1;
+  }
+
+  return 0;
+}
+
+/**
+ * Wraps a temporary file holding `count` sorted values (at least one) in a new
+ * run, flushing what was written and reading its first block.
+ *
+ * @return A pointer to the run, or `NULL` if the file couldn't be flushed or
+ *   read back (in which case it is left open).
+ */
+static Run *newRun(FILE *file, long long count, int level) {
+  if (fflush(file)) {
+    printf("Error: failed to write a run to disk.\n");
+    return NULL;
+  }
+
+  Run *run = malloc(sizeof(Run));
+  run->file = file;
+  run->remaining = count;
+  run->bufferLength = 0;
+  run->bufferPos = 0;
+  run->level = level;
+
+  rewind(file);
+  if (readBlock(run)) {
+    free(run);
+    return NULL;
+  }
+
+  return run;
+}
+
+/** Closes a run's temporary file (which deletes it) and frees the run. */
+static void destroyRun(Run *run) {
+  fclose(run->file);
+  free(run);
+}
+
+/**
+ * Places a run in a heap of runs at a given index, then continues to swap it
+ * with the child whose head is least until its head is less than or equal to
+ * both children's heads or it reaches the last level of the tree.
+ */
+static void siftDownRun(Run **runs, int length, int currentIdx, Run *run) {
+  while (2 * currentIdx + 1 < length) {
+    int childIdx = 2 * currentIdx + 1;
+    if (childIdx + 1 < length &&
+        head(runs[childIdx + 1]) < head(runs[childIdx]))
+      childIdx++;
+    if (head(run) <= head(runs[childIdx]))
+      break;
+
+    runs[currentIdx] = runs[childIdx];
+    currentIdx = childIdx;
+  }
+
+  runs[currentIdx] = run;
+}
+
+/** Builds a heap of runs keyed by their heads (Floyd's method). */
+static void heapifyRuns(Run **runs, int length) {
+  for (int i = length / 2 - 1; i >= 0; i--) {
+    siftDownRun(runs, length, i, runs[i]);
+  }
+}
+
+/**
+ * Consumes the least head from a heap of runs, removing its run from the heap
+ * once it is exhausted.
+ *
+ * @param runs A pointer to the heap of runs.
+ * @param length A pointer to the number of runs in the heap.
+ * @param value A pointer that will receive the value consumed.
+ * @return `0` if a value was consumed, `1` if its run couldn't be read from
+ *   disk, in which case the heap of runs is left as it was.
+ */
+static int popRunHeap(Run **runs, int *length, int *value) {
+  Run *run = runs[0];
+  *value = head(run);
+  if (consumeHead(run))
+    return 1;
+
+  if (!isExhausted(run)) {
+    siftDownRun(runs, *length, 0, run);
+  } else {
+    (*length)--;
+    if (*length > 0)
+      siftDownRun(runs, *length, 0, runs[*length]);
+  }
+
+  return 0;
+}
+
+/**
+ * Appends a run to an external-memory min heap's list of runs and rebuilds
+ * the heap of runs to include it.
+ */
+static void addRun(ExternalMinHeap *heap, Run *run) {
+  if (heap->numRuns == heap->runCapacity) {
+    heap->runCapacity *= 2;
+    heap->runs = realloc(heap->runs, heap->runCapacity * sizeof(Run *));
+    heap->runHeap = realloc(heap->runHeap, heap->runCapacity * sizeof(Run *));
+  }
+
+  heap->runs[heap->numRuns++] = run;
+  memcpy(heap->runHeap, heap->runs, heap->numRuns * sizeof(Run *));
+  heapifyRuns(heap->runHeap, heap->numRuns);
+}
+
+/**
+ * Merges the runs of an external-memory min heap from a given index onward
+ * (which must all share a level) into a single run of the next level. If any
+ * I/O fails, the merging runs are rolled back to where they were, so no value
+ * is lost and the merge can be tried again later.
+ *
+ * @return `0` if the runs were successfully merged, `1` if a temporary file
+ *   couldn't be created, written or read back, or a run couldn't be read.
+ */
+static int mergeRuns(ExternalMinHeap *heap, int first) {
+  FILE *file = tmpfile();
+  if (!file) {
+    printf("Error: failed to create a temporary file.\n");
+    return 1;
+  }
+
+  int count = heap->numRuns - first;
+  int level = heap->runs[first]->level + 1;
+  Run **merging = &heap->runs[first];
+
+  // Remember where every merging run was, to roll back to on failure
+  Run *saved = malloc(count * sizeof(Run));
+  fpos_t *positions = malloc(count * sizeof(fpos_t));
+  bool failed = false;
+  for (int i = 0; i < count && !failed; i++) {
+    saved[i] = *merging[i];
+    failed = fgetpos(merging[i]->file, &positions[i]) != 0;
+  }
+
+  // Only the merging runs are kept in the heap of runs until they are done
+  memcpy(heap->runHeap, merging, count * sizeof(Run *));
+  heapifyRuns(heap->runHeap, count);
+
+  int output[RUN_BUFFER_SIZE];
+  int outputLength = 0;
+  long long total = 0;
+  int remainingRuns = count;
+  while (!failed && remainingRuns > 0) {
+    failed = popRunHeap(heap->runHeap, &remainingRuns, &output[outputLength]);
+    if (!failed)
+      outputLength++;
+
+    if (!failed &&
+        (outputLength == RUN_BUFFER_SIZE || remainingRuns == 0)) {
+      if (fwrite(output, sizeof(int), outputLength, file) !=
+          (size_t)outputLength) {
+        printf("Error: failed to write a run to disk.\n");
+        failed = true;
+      }
+      total += outputLength;
+      outputLength = 0;
+    }
+  }
+
+  Run *merged = failed ? NULL : newRun(file, total, level);
+  if (!merged) {
+    fclose(file);
+    for (int i = 0; i < count; i++) {
+      *merging[i] = saved[i];
+      clearerr(merging[i]->file);
+      fsetpos(merging[i]->file, &positions[i]);
+    }
+    memcpy(heap->runHeap, heap->runs, heap->numRuns * sizeof(Run *));
+    heapifyRuns(heap->runHeap, heap->numRuns);
+  } else {
+    for (int i = 0; i < count; i++) {
+      destroyRun(merging[i]);
+    }
+    heap->numRuns = first;
+    addRun(heap, merged);
+  }
+
+  free(saved);
+  free(positions);
+  return merged ? 0 : 1;
+}
+
+/**
+ * Sorts the values in an external-memory min heap's in-memory heap and writes
+ * them to disk as a new level `0` run, then merges any levels that have
+ * filled up. If the run can't be written, the values stay in memory: sorted,
+ * they still form a valid heap. If a merge fails, its runs are just left
+ * unmerged until the next spill, since the values are already safely on disk.
+ *
+ * @return `0` if the values were successfully spilled, `1` if a temporary file
+ *   couldn't be created or written.
+ */
+static int spill(ExternalMinHeap *heap) {
+  FILE *file = tmpfile();
+  if (!file) {
+    printf("Error: failed to create a temporary file.\n");
+    return 1;
+  }
+
+  // Heapsort in place: swapping the root to the end leaves the values ordered
+  // from greatest to least, so write them out back to front
+  int *array = heap->heap;
+  for (int end = heap->heapLength - 1; end > 0; end--) {
+    int root = array[0];
+    int value = array[end];
+    int currentIdx = 0;
+    while (2 * currentIdx + 1 < end) {
+      int childIdx = 2 * currentIdx + 1;
+      if (childIdx + 1 < end && array[childIdx + 1] < array[childIdx])
+        childIdx++;
+      if (value <= array[childIdx])
+        break;
+
+      array[currentIdx] = array[childIdx];
+      currentIdx = childIdx;
+    }
+    array[currentIdx] = value;
+    array[end] = root;
+  }
+  for (int i = 0; i < heap->heapLength / 2; i++) {
+    int temp = array[i];
+    array[i] = array[heap->heapLength - 1 - i];
+    array[heap->heapLength - 1 - i] = temp;
+  }
+
+  Run *run = NULL;
+  if (fwrite(array, sizeof(int), heap->heapLength, file) !=
+      (size_t)heap->heapLength) {
+    printf("Error: failed to write a run to disk.\n");
+  } else {
+    run = newRun(file, heap->heapLength, 0);
+  }
+  if (!run) {
+    fclose(file);
+    return 1;
+  }
+
+  addRun(heap, run);
+  heap->heapLength = 0;
+
+  // Merge the newest level whenever it fills up, which may cascade. (A level
+  // can hold more than `FAN_IN` runs after a failed merge, and then all of
+  // them are merged at once by a later spill.)
+  while (true) {
+    int level = heap->runs[heap->numRuns - 1]->level;
+    int first = heap->numRuns;
+    while (first > 0 && heap->runs[first - 1]->level == level) {
+      first--;
+    }
+    if (heap->numRuns - first < FAN_IN)
+      break;
+    if (mergeRuns(heap, first))
+      break;
+  }
+
+  return 0;
+}
+
+/**
+ * Adds a value to an external-memory min heap, spilling the in-memory heap to
+ * disk first if it is full.
+ *
+ * @param heap A pointer to the external-memory min heap.
+ * @param value The value to add.
+ * @return `0` if the value was successfully added, `1` if the in-memory heap
+ *   couldn't be spilled to disk (in which case the value isn't added, but every
+ *   value already held is kept).
+ */
+int push(ExternalMinHeap *heap, int value) {
+  if (heap->heapLength == heap->memoryBudget && spill(heap))
+    return 1;
+
+  int currentIdx = heap->heapLength++;
+  while (currentIdx > 0 && value < heap->heap[(currentIdx - 1) / 2]) {
+    heap->heap[currentIdx] = heap->heap[(currentIdx - 1) / 2];
+    currentIdx = (currentIdx - 1) / 2;
+  }
+
+  heap->heap[currentIdx] = value;
+  heap->length++;
+  return 0;
+}
+
+/** Returns whether the least value lies in a run rather than in memory. */
+static bool leastIsOnDisk(ExternalMinHeap *heap) {
+  return heap->numRuns > 0 &&
+         (heap->heapLength == 0 || head(heap->runHeap[0]) < heap->heap[0]);
+}
+
+/**
+ * Returns a pointer to the least value in an external-memory min heap (or
+ * `NULL` if the heap is empty), leaving it in place.
+ */
+int *peek(ExternalMinHeap *heap) {
+  if (isEmpty(heap))
+    return NULL;
+
+  if (leastIsOnDisk(heap))
+    return &heap->runHeap[0]->buffer[heap->runHeap[0]->bufferPos];
+  return &heap->heap[0];
+}
+
+/**
+ * Removes the least value from an external-memory min heap.
+ *
+ * @param heap A pointer to the external-memory min heap.
+ * @param value A pointer that will receive the value removed.
+ * @return `0` if a value was successfully removed, `1` if the heap was already
+ *   empty or a spilled run couldn't be read back from disk (in which case the
+ *   heap is left as it was).
+ */
+int pop(ExternalMinHeap *heap, int *value) {
+  if (isEmpty(heap))
+    return 1;
+
+  if (leastIsOnDisk(heap)) {
+    Run *run = heap->runHeap[0];
+    int numRuns = heap->numRuns;
+    if (popRunHeap(heap->runHeap, &numRuns, value))
+      return 1;
+
+    // Drop the run if that was its last value
+    if (numRuns < heap->numRuns) {
+      int idx = 0;
+      while (heap->runs[idx] != run) {
+        idx++;
+      }
+      memmove(&heap->runs[idx], &heap->runs[idx + 1],
+              (heap->numRuns - idx - 1) * sizeof(Run *));
+      heap->numRuns--;
+      destroyRun(run);
+    }
+  } else {
+    int *array = heap->heap;
+    *value = array[0];
+    heap->heapLength--;
+
+    int last = array[heap->heapLength];
+    int currentIdx = 0;
+    while (2 * currentIdx + 1 < heap->heapLength) {
+      int childIdx = 2 * currentIdx + 1;
+      if (childIdx + 1 < heap->heapLength &&
+          array[childIdx + 1] < array[childIdx])
+        childIdx++;
+      if (last <= array[childIdx])
+        break;
+
+      array[currentIdx] = array[childIdx];
+      currentIdx = childIdx;
+    }
+    array[currentIdx] = last;
+  }
+
+  heap->length--;
+  return 0;
+}
+
+/** Clears the contents of an external-memory min heap, deleting its runs. */
+void clear(ExternalMinHeap *heap) {
+  for (int i = 0; i < heap->numRuns; i++) {
+    destroyRun(heap->runs[i]);
+  }
+  heap->numRuns = 0;
+  heap->heapLength = 0;
+  heap->length = 0;
+}
+
+/** Frees the allocated memory for an external-memory min heap. */
+void destroy(ExternalMinHeap *heap) {
+  clear(heap);
+  free(heap->heap);
+  free(heap->runs);
+  free(heap->runHeap);
+  free(heap);
+}
+
+static int compareInts(const void *a, const void *b) {
+  return (*(int *)a > *(int *)b) - (*(int *)a < *(int *)b);
+}
+
+/** Limits the size of any file this process writes, in bytes. */
+static void limitFileSize(rlim_t bytes) {
+  struct rlimit limit;
+  getrlimit(RLIMIT_FSIZE, &limit);
+  limit.rlim_cur = bytes;
+  setrlimit(RLIMIT_FSIZE, &limit);
+}
+
+/** Pops every value from a heap, checking they come out sorted. */
+static bool popsInOrder(ExternalMinHeap *heap, int *values, int count) {
+  qsort(values, count, sizeof(int), compareInts);
+  int value;
+  for (int i = 0; i < count; i++) {
+    if (pop(heap, &value) || value != values[i])
+      return false;
+  }
+
+  return isEmpty(heap);
+}
+
+#define BUDGET 1000
+#define N (100 * BUDGET)
+
+int main() {
+  assert(newExternalMinHeap(0) == NULL);
+
+  ExternalMinHeap *h = newExternalMinHeap(BUDGET);
+  int value;
+
+  assert(isEmpty(h));
+  assert(peek(h) == NULL);
+  assert(pop(h, &value) == 1);
+
+  // Push 100 times as many values as fit in memory, then pop them in order
+  int *values = malloc(N * sizeof(int));
+  for (int i = 0; i < N; i++) {
+    values[i] = rand();
+    assert(push(h, values[i]) == 0);
+  }
+  assert(length(h) == N);
+  assert(h->heapLength <= BUDGET);
+  assert(h->numRuns > 0 && h->numRuns < 2 * FAN_IN);
+  assert(h->runs[0]->level >= 1);
+
+  qsort(values, N, sizeof(int), compareInts);
+  for (int i = 0; i < N; i++) {
+    assert(*peek(h) == values[i]);
+    assert(pop(h, &value) == 0);
+    assert(value == values[i]);
+  }
+  assert(isEmpty(h));
+  assert(h->numRuns == 0);
+  assert(pop(h, &value) == 1);
+
+  // Interleaved pushes and pops always return the least value held
+  int counts[100] = {0};
+  int held = 0;
+  for (int i = 0; i < N; i++) {
+    if (held > 0 && rand() % 3 == 0) {
+      int least = 0;
+      while (counts[least] == 0) {
+        least++;
+      }
+      assert(pop(h, &value) == 0);
+      assert(value == least);
+      counts[least]--;
+      held--;
+    } else {
+      value = rand() % 100;
+      assert(push(h, value) == 0);
+      counts[value]++;
+      held++;
+    }
+  }
+  assert(length(h) == held);
+
+  clear(h);
+  assert(isEmpty(h));
+  assert(h->numRuns == 0);
+
+  // A run that can't be written keeps its values in memory
+  struct rlimit original;
+  getrlimit(RLIMIT_FSIZE, &original);
+  signal(SIGXFSZ, SIG_IGN);
+  limitFileSize(BUDGET);
+  for (int i = 0; i < BUDGET; i++) {
+    values[i] = rand();
+    assert(push(h, values[i]) == 0);
+  }
+  assert(push(h, 0) == 1);
+  assert(length(h) == BUDGET && h->numRuns == 0);
+  limitFileSize(original.rlim_cur);
+  assert(popsInOrder(h, values, BUDGET));
+
+  // A merge that can't be written leaves its runs as they were, but the run
+  // that triggered it is still spilled and the value still added
+  limitFileSize(BUDGET * sizeof(int));
+  for (int i = 0; i <= FAN_IN * BUDGET; i++) {
+    values[i] = rand();
+    assert(push(h, values[i]) == 0);
+  }
+  assert(length(h) == FAN_IN * BUDGET + 1);
+  assert(h->numRuns == FAN_IN && h->heapLength == 1);
+  for (int i = 0; i < FAN_IN; i++) {
+    assert(h->runs[i]->level == 0);
+  }
+  limitFileSize(original.rlim_cur);
+  for (int i = FAN_IN * BUDGET + 1; i <= (FAN_IN + 1) * BUDGET; i++) {
+    values[i] = rand();
+    assert(push(h, values[i]) == 0);
+  }
+  assert(h->numRuns == 1 && h->runs[0]->level == 1);
+  assert(popsInOrder(h, values, (FAN_IN + 1) * BUDGET + 1));
+
+  // A run that can't be read back fails to pop without losing anything
+  for (int i = 0; i < 2 * FAN_IN * BUDGET; i++) {
+    values[i] = rand();
+    assert(push(h, values[i]) == 0);
+  }
+  assert(h->runs[0]->level == 1);
+  FILE *runFile = h->runs[0]->file;
+  h->runs[0]->file = fopen("/dev/null", "w");
+  int popped = 0;
+  while (pop(h, &value) == 0) {
+    popped++;
+  }
+  assert(popped > 0 && length(h) == 2 * FAN_IN * BUDGET - popped);
+  assert(pop(h, &value) == 1);
+  fclose(h->runs[0]->file);
+  h->runs[0]->file = runFile;
+
+  qsort(values, 2 * FAN_IN * BUDGET, sizeof(int), compareInts);
+  assert(popsInOrder(h, values + popped, 2 * FAN_IN * BUDGET - popped));
+
+  free(values);
+  destroy(h);
+  printf("All tests passed successfully.\n");
+
+  return 0;
+}
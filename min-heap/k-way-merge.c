@@ -0,0 +1,470 @@
+#include <assert.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * A cursor over a sorted input: `next` writes the input's next value to
+ * `*value` and returns `0`, returns `1` once the input is exhausted, or returns
+ * `2` if the input couldn't be read. `state` is passed back to `next` and
+ * points at whatever the input needs to keep track of its position (see
+ * `ArraySource` and `FileSource`).
+ */
+typedef struct Cursor {
+  int (*next)(void *state, int *value);
+  void *state;
+} Cursor;
+
+/** A cursor source that reads values from an in-memory array. */
+typedef struct ArraySource {
+  int *values;
+  int length;
+  int position;
+} ArraySource;
+
+/** Reads the next value of an array source. */
+int arraySourceNext(void *state, int *value) {
+  ArraySource *source = state;
+  if (source->position == source->length)
+    return 1;
+
+  *value = source->values[source->position++];
+  return 0;
+}
+
+/** Returns a cursor over an array source. */
+Cursor arrayCursor(ArraySource *source) {
+  return (Cursor){arraySourceNext, source};
+}
+
+/** The number of values a file source reads from disk at a time. */
+#define FILE_BUFFER_SIZE 4096
+
+/**
+ * A cursor source that reads binary `int` values from a file, a block of
+ * `FILE_BUFFER_SIZE` values at a time, so merging many files only ever does
+ * large sequential reads. A read error, or a file ending partway through a
+ * value, fails the source once the values read before it have been used.
+ */
+typedef struct FileSource {
+  FILE *file;
+  int length;
+  int position;
+  bool failed; // Whether the last read hit an error or a truncated value
+  int buffer[FILE_BUFFER_SIZE];
+} FileSource;
+
+/**
+ * Constructs a new file source reading from an open file's current position
+ * and returns a pointer to it. (Make sure to `free` the pointer once you're
+ * finished with it; the file is left open.)
+ */
+FileSource *newFileSource(FILE *file) {
+  FileSource *ptr = malloc(sizeof(FileSource));
+
+  ptr->file = file;
+  ptr->length = 0;
+  ptr->position = 0;
+  ptr->failed = false;
+
+  return ptr;
+}
+
+/** Reads the next value of a file source, refilling its buffer if needed. */
+int fileSourceNext(void *state, int *value) {
+  FileSource *source = state;
+  if (source->position == source->length) {
+    if (source->failed)
+      return 2;
+
+    // Read bytes rather than whole values, so a truncated value is noticed
+    size_t bytes =
+        fread(source->buffer, 1, sizeof(source->buffer), source->file);
+    source->length = bytes / sizeof(int);
+    source->position = 0;
+    if (ferror(source->file)) {
+      printf("Error: failed to read a file source.\n");
+      source->failed = true;
+    } else if (bytes % sizeof(int) != 0) {
+      printf("Error: file source ends partway through a value.\n");
+      source->failed = true;
+    }
+
+    if (source->length == 0)
+      return source->failed ? 2 : 1;
+  }
+
+  *value = source->buffer[source->position++];
+  return 0;
+}
+
+/** Returns a cursor over a file source. */
+Cursor fileCursor(FileSource *source) {
+  return (Cursor){fileSourceNext, source};
+}
+
+/** The head of one input: its least unmerged value and which input it is. */
+typedef struct Head {
+  int value;
+  int source;
+} Head;
+
+/**
+ * A streaming k-way merge of sorted inputs into one sorted output. The head of
+ * every input that isn't exhausted is kept in a binary min heap implemented
+ * as an implicit data structure, as in `MinHeap`, with each value stored
+ * alongside the index of the input it came from.
+ *
+ * Producing a value takes the root and reads the next value from the same
+ * input, which replaces the root in a single sift-down ("replace-top") rather
+ * than a pop followed by a push. Only when an input runs out does the heap
+ * shrink. Ties between inputs are broken by input index, so the merge is
+ * stable with respect to input order.
+ *
+ * If an input can't be read, the merge fails: the order of whatever follows is
+ * unknown, so no more values are produced, rather than silently leaving out
+ * the rest of that input.
+ */
+typedef struct KWayMerge {
+  int length; // Inputs that aren't exhausted
+  bool failed;
+  Cursor *cursors;
+  Head heads[];
+} KWayMerge;
+
+/** Returns whether head `a` should be merged before head `b`. */
+static bool comesBefore(Head a, Head b) {
+  return a.value < b.value || (a.value == b.value && a.source < b.source);
+}
+
+/**
+ * Places a head in a merge's heap at a given index, then continues to swap it
+ * with its least child until it comes before both children or it reaches the
+ * last level of the tree.
+ */
+static void siftDown(KWayMerge *merge, int currentIdx, Head head) {
+  Head *heads = merge->heads;
+  while (2 * currentIdx + 1 < merge->length) {
+    int childIdx = 2 * currentIdx + 1;
+    if (childIdx + 1 < merge->length &&
+        comesBefore(heads[childIdx + 1], heads[childIdx]))
+      childIdx++;
+    if (!comesBefore(heads[childIdx], head))
+      break;
+
+    heads[currentIdx] = heads[childIdx];
+    currentIdx = childIdx;
+  }
+
+  heads[currentIdx] = head;
+}
+
+/**
+ * Constructs a new k-way merge over some sorted inputs and returns a pointer to
+ * it, reading the first value of every input. (Make sure to `free` the pointer
+ * once you're finished with it.)
+ *
+ * @param cursors A pointer to the first of `k` cursors, one per input, which
+ *   must stay valid for as long as the merge is in use.
+ * @param k The number of inputs.
+ * @return A pointer to the k-way merge, or `NULL` if an input couldn't be
+ *   read.
+ */
+KWayMerge *newKWayMerge(Cursor *cursors, int k) {
+  if (k < 1) {
+    printf("Error: number of inputs must be positive.\n");
+    return NULL;
+  }
+
+  KWayMerge *ptr = malloc(sizeof(KWayMerge) + k * sizeof(Head));
+
+  ptr->length = 0;
+  ptr->failed = false;
+  ptr->cursors = cursors;
+  for (int i = 0; i < k; i++) {
+    int value;
+    int status = cursors[i].next(cursors[i].state, &value);
+    if (status == 0) {
+      ptr->heads[ptr->length++] = (Head){value, i};
+    } else if (status == 2) {
+      free(ptr);
+      return NULL;
+    }
+  }
+
+  // Build the heap in O(k) (Floyd's method)
+  for (int i = ptr->length / 2 - 1; i >= 0; i--) {
+    siftDown(ptr, i, ptr->heads[i]);
+  }
+
+  return ptr;
+}
+
+/** Returns whether or not every input of a k-way merge has been merged. */
+bool isEmpty(KWayMerge *merge) { return merge->length == 0; }
+
+/**
+ * Produces the next value of a k-way merge's sorted output.
+ *
+ * @param merge A pointer to the k-way merge.
+ * @param value A pointer that will receive the value.
+ * @param source A pointer that will receive the index of the input the value
+ *   came from, or `NULL` if it isn't needed.
+ * @return `0` if a value was produced, `1` if every input is exhausted, `2` if
+ *   an input couldn't be read (which fails the merge, so every later call
+ *   returns `2` too).
+ */
+int next(KWayMerge *merge, int *value, int *source) {
+  if (merge->failed)
+    return 2;
+  if (isEmpty(merge))
+    return 1;
+
+  Head top = merge->heads[0];
+  *value = top.value;
+  if (source)
+    *source = top.source;
+
+  // Replace the root with the next value from the same input if there is one,
+  // or else with the last head. The value already read is still produced if
+  // the input fails, and the failure is reported by the next call
+  Cursor *cursor = &merge->cursors[top.source];
+  int status = cursor->next(cursor->state, &top.value);
+  if (status == 0) {
+    siftDown(merge, 0, top);
+  } else if (status == 2) {
+    merge->failed = true;
+  } else {
+    merge->length--;
+    if (merge->length > 0)
+      siftDown(merge, 0, merge->heads[merge->length]);
+  }
+
+  return 0;
+}
+
+/**
+ * Produces up to `maxCount` values of a k-way merge's sorted output at once.
+ *
+ * @param merge A pointer to the k-way merge.
+ * @param buffer A pointer to an array with room for at least `maxCount`
+ *   values.
+ * @param maxCount The maximum number of values to produce.
+ * @return The number of values produced, which will be less than `maxCount`
+ *   once every input is exhausted or an input couldn't be read, or `-1` if the
+ *   merge had already failed.
+ */
+int nextMany(KWayMerge *merge, int *buffer, int maxCount) {
+  if (merge->failed)
+    return -1;
+
+  int count = 0;
+  while (count < maxCount && next(merge, &buffer[count], NULL) == 0) {
+    count++;
+  }
+
+  return count;
+}
+
+static double secondsSince(struct timespec *start) {
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * Merges `k` sorted arrays of `n / k` values, once with replace-top and once
+ * with a separate pop and push per value, as a heap of values alongside a
+ * table of sources would.
+ */
+static void benchmark(int n, int k) {
+  int perInput = n / k;
+  int *values = malloc((size_t)perInput * k * sizeof(int));
+  ArraySource *sources = malloc(k * sizeof(ArraySource));
+  Cursor *cursors = malloc(k * sizeof(Cursor));
+  srand(42);
+  for (int i = 0; i < k; i++) {
+    int value = 0;
+    for (int j = 0; j < perInput; j++) {
+      value += rand() % 1000;
+      values[i * perInput + j] = value;
+    }
+  }
+
+  struct timespec start;
+  long long checksum = 0, popPushChecksum = 0;
+
+  for (int i = 0; i < k; i++) {
+    sources[i] = (ArraySource){values + i * perInput, perInput, 0};
+    cursors[i] = arrayCursor(&sources[i]);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  KWayMerge *merge = newKWayMerge(cursors, k);
+  int value;
+  for (long long i = 0; next(merge, &value, NULL) == 0; i++) {
+    checksum += value * (i % 7);
+  }
+  printf("replace-top merge: %.3fs\n", secondsSince(&start));
+  free(merge);
+
+  // Pop the root, then push the next value from its input
+  for (int i = 0; i < k; i++) {
+    sources[i].position = 0;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  merge = newKWayMerge(cursors, k);
+  for (long long i = 0; !isEmpty(merge); i++) {
+    Head top = merge->heads[0];
+    popPushChecksum += top.value * (i % 7);
+
+    merge->length--;
+    if (merge->length > 0)
+      siftDown(merge, 0, merge->heads[merge->length]);
+
+    if (cursors[top.source].next(&sources[top.source], &top.value) == 0) {
+      int currentIdx = merge->length++;
+      while (currentIdx > 0 &&
+             comesBefore(top, merge->heads[(currentIdx - 1) / 2])) {
+        merge->heads[currentIdx] = merge->heads[(currentIdx - 1) / 2];
+        currentIdx = (currentIdx - 1) / 2;
+      }
+      merge->heads[currentIdx] = top;
+    }
+  }
+  printf("pop and push merge: %.3fs\n", secondsSince(&start));
+  assert(checksum == popPushChecksum);
+
+  free(merge);
+  free(cursors);
+  free(sources);
+  free(values);
+}
+
+int main(int argc, char *argv[]) {
+  assert(newKWayMerge(NULL, 0) == NULL);
+
+  // Merge arrays of different lengths, including an empty one
+  int a[] = {1, 4, 7, 10};
+  int b[] = {2, 4, 6};
+  int c[] = {0, 3, 11, 12, 13};
+  ArraySource sources[] = {{a, 4, 0}, {b, 3, 0}, {NULL, 0, 0}, {c, 5, 0}};
+  Cursor cursors[4];
+  for (int i = 0; i < 4; i++) {
+    cursors[i] = arrayCursor(&sources[i]);
+  }
+
+  KWayMerge *merge = newKWayMerge(cursors, 4);
+  int expected[] = {0, 1, 2, 3, 4, 4, 6, 7, 10, 11, 12, 13};
+  int expectedSources[] = {3, 0, 1, 3, 0, 1, 1, 0, 0, 3, 3, 3};
+  int value, source;
+  for (int i = 0; i < 12; i++) {
+    assert(next(merge, &value, &source) == 0);
+    assert(value == expected[i]);
+    assert(source == expectedSources[i]);
+  }
+  assert(isEmpty(merge));
+  assert(next(merge, &value, &source) == 1);
+  free(merge);
+
+  // Merge many buffered files, each spanning several buffers
+  int k = 100;
+  int perFile = 3 * FILE_BUFFER_SIZE + 5;
+  FILE *files[100];
+  FileSource *fileSources[100];
+  Cursor fileCursors[100];
+  int *counts = calloc(k * perFile, sizeof(int));
+  for (int i = 0; i < k; i++) {
+    files[i] = tmpfile();
+    for (int j = 0; j < perFile; j++) {
+      int v = (j * k + rand() % k) / 2;
+      fwrite(&v, sizeof(int), 1, files[i]);
+      counts[v]++;
+    }
+    rewind(files[i]);
+    fileSources[i] = newFileSource(files[i]);
+    fileCursors[i] = fileCursor(fileSources[i]);
+  }
+
+  merge = newKWayMerge(fileCursors, k);
+  int buffer[1000];
+  int previous = INT_MIN;
+  long long total = 0;
+  int count;
+  while ((count = nextMany(merge, buffer, 1000)) > 0) {
+    for (int i = 0; i < count; i++) {
+      assert(buffer[i] >= previous);
+      previous = buffer[i];
+      counts[buffer[i]]--;
+    }
+    total += count;
+  }
+  assert(total == (long long)k * perFile);
+  for (int i = 0; i < k * perFile; i++) {
+    assert(counts[i] == 0);
+  }
+
+  free(merge);
+  for (int i = 0; i < k; i++) {
+    free(fileSources[i]);
+    fclose(files[i]);
+  }
+  free(counts);
+
+  // A file ending partway through a value fails the merge once the values
+  // before it are used up, rather than silently ending that input
+  FILE *truncated = tmpfile();
+  fwrite((int[]){1, 3, 5}, sizeof(int), 3, truncated);
+  fwrite("xy", 1, 2, truncated);
+  rewind(truncated);
+  FileSource *truncatedSource = newFileSource(truncated);
+  int evens[] = {2, 4, 6};
+  ArraySource evenSource = {evens, 3, 0};
+  Cursor mixed[] = {fileCursor(truncatedSource), arrayCursor(&evenSource)};
+  merge = newKWayMerge(mixed, 2);
+  assert(nextMany(merge, buffer, 1000) == 5);
+  assert(memcmp(buffer, (int[]){1, 2, 3, 4, 5}, 5 * sizeof(int)) == 0);
+  assert(next(merge, &value, NULL) == 2);
+  assert(nextMany(merge, buffer, 1000) == -1);
+  free(merge);
+  free(truncatedSource);
+  fclose(truncated);
+
+  // So does a read error, whether it happens up front or partway through
+  FILE *unreadable = fopen("/dev/null", "w");
+  FileSource *failingSource = newFileSource(unreadable);
+  Cursor failing = fileCursor(failingSource);
+  assert(newKWayMerge(&failing, 1) == NULL);
+  free(failingSource);
+
+  FILE *longFile = tmpfile();
+  for (int i = 0; i < FILE_BUFFER_SIZE + 10; i++) {
+    fwrite(&i, sizeof(int), 1, longFile);
+  }
+  rewind(longFile);
+  failingSource = newFileSource(longFile);
+  failing = fileCursor(failingSource);
+  merge = newKWayMerge(&failing, 1);
+  failingSource->file = unreadable;
+  int *longBuffer = malloc(2 * FILE_BUFFER_SIZE * sizeof(int));
+  assert(nextMany(merge, longBuffer, 2 * FILE_BUFFER_SIZE) ==
+         FILE_BUFFER_SIZE);
+  assert(longBuffer[FILE_BUFFER_SIZE - 1] == FILE_BUFFER_SIZE - 1);
+  assert(next(merge, &value, NULL) == 2);
+  free(longBuffer);
+  free(merge);
+  free(failingSource);
+  fclose(longFile);
+  fclose(unreadable);
+  printf("All tests passed successfully.\n");
+
+  // Pass `bench [number of values] [number of inputs]` to compare against
+  // popping and pushing separately
+  if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    benchmark(argc > 2 ? atoi(argv[2]) : 10000000,
+              argc > 3 ? atoi(argv[3]) : 256);
+
+  return 0;
+}
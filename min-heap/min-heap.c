@@ -1,8 +1,14 @@
 #include <assert.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <limits.h>
+#include <string.h>
+
+#include "../generic-heap/generic-heap.h"
+
+#define LESS_THAN(a, b) ((a) < (b))
+#define GREATER_THAN(a, b) ((a) > (b))
 
 /**
  * A binary min heap implemented as an implicit data structure. Keys are stored
@@ -11,39 +17,51 @@
  * will be located at `2 * i + 1` and `2 * i + 2`, and its parent will be
  * located at `(i - 1) / 2` (using integer division). All parent nodes will be
  * less than or equal to their child nodes.
+ *
+ * The heap is generated by `DEFINE_HEAP`, and the functions below are thin
+ * wrappers over it. Construct one with `newMinHeap(maxSize)` (and `destroy` it
+ * once you're finished with it): its internal array starts small and grows
+ * geometrically as values are added, so `maxSize` only caps the heap's size
+ * rather than being allocated up front. Pass `INT_MAX` for no practical limit.
  */
-typedef struct MinHeap {
-  int maxSize;
-  int length;
-  int array[];
-} MinHeap;
+DEFINE_HEAP(MinHeap, int, LESS_THAN)
 
 /**
- * Constructs a new instance of a min heap and returns a pointer to it. (Make
- * sure to `free` the pointer once you're finished with it.)
+ * A max heap used by `nsmallest` to keep the least values seen so far, whose
+ * root is the first to be evicted.
  */
-MinHeap *newMinHeap(int maxSize) {
-  if (maxSize < 1) {
-    printf("Error: maximum size must be positive.\n");
-    return NULL;
-  }
-
-  MinHeap *ptr = malloc(sizeof(MinHeap) + maxSize * sizeof(int));
-
-  ptr->maxSize = maxSize;
-  ptr->length = 0;
-
-  return ptr;
-}
+DEFINE_HEAP(BoundedMaxHeap, int, GREATER_THAN)
 
 /** Returns the number of values in a min heap. */
-int length(MinHeap *heap) { return heap->length; }
+int length(MinHeap *heap) { return MinHeapLength(heap); }
 
 /** Returns whether or not a min heap is empty. */
-bool isEmpty(MinHeap *heap) { return length(heap) == 0; }
+bool isEmpty(MinHeap *heap) { return MinHeapIsEmpty(heap); }
 
 /** Returns whether or not a min heap is full. */
-bool isFull(MinHeap *heap) { return length(heap) == heap->maxSize; }
+bool isFull(MinHeap *heap) { return MinHeapIsFull(heap); }
+
+/**
+ * Makes sure a min heap's internal array has room for at least a given number
+ * of values, so that adding up to that many values won't reallocate it.
+ *
+ * @param heap A pointer to the min heap.
+ * @param capacity The number of values to make room for.
+ * @return `0` if there is now enough room, `1` if `capacity` exceeds the heap's
+ *   maximum size or memory couldn't be allocated.
+ */
+int reserve(MinHeap *heap, int capacity) {
+  return MinHeapReserve(heap, capacity);
+}
+
+/**
+ * Shrinks a min heap's internal array to fit the values it currently holds,
+ * returning unused memory after a burst of values has drained.
+ */
+void shrinkToFit(MinHeap *heap) { MinHeapShrinkToFit(heap); }
+
+/** Frees the allocated memory for a min heap. */
+void destroy(MinHeap *heap) { MinHeapDestroy(heap); }
 
 /**
  * Adds a value to a min heap, maintaining the heap property.
@@ -53,25 +71,36 @@ bool isFull(MinHeap *heap) { return length(heap) == heap->maxSize; }
  * @return `0` if the value was successfully added, `1` if the min heap was
  *   already at maximum capacity (stack overflow).
  */
-int push(MinHeap *heap, int value) {
-  if (isFull(heap)) {
-    printf("Error: stack overflow: heap is already at maximum capacity.\n");
-    return 1;
-  }
-
-  int currentIndex = heap->length;
-  int parentIndex = (currentIndex - 1) / 2;
-  while (currentIndex > 0 && value < heap->array[parentIndex]) {
-    // Switch with parent
-    heap->array[currentIndex] = heap->array[parentIndex];
-    currentIndex = parentIndex;
+int push(MinHeap *heap, int value) { return MinHeapPush(heap, value); }
 
-    parentIndex = (currentIndex - 1) / 2;
-  }
+/**
+ * Constructs a new instance of a min heap holding a copy of the values in an
+ * array, and returns a pointer to it. (Make sure to `destroy` the heap once
+ * you're finished with it.)
+ *
+ * @param values A pointer to the first value to copy.
+ * @param length The number of values to copy.
+ * @param maxSize The maximum size of the heap, which must be at least
+ *   `length`.
+ * @return A pointer to the min heap, or `NULL` if `maxSize` was too small.
+ */
+MinHeap *newMinHeapFromArray(int *values, int length, int maxSize) {
+  return MinHeapFromArray(values, length, maxSize);
+}
 
-  heap->array[currentIndex] = value;
-  heap->length++;
-  return 0;
+/**
+ * Adds several values to a min heap, maintaining the heap property. Large
+ * batches are appended all at once and the heap is rebuilt, which is cheaper
+ * than pushing them one by one.
+ *
+ * @param heap A pointer to the min heap.
+ * @param values A pointer to the first value to add.
+ * @param count The number of values to add.
+ * @return `0` if the values were successfully added, `1` if the min heap didn't
+ *   have room for all of them (in which case none are added).
+ */
+int pushMany(MinHeap *heap, int *values, int count) {
+  return MinHeapPushMany(heap, values, count);
 }
 
 /**
@@ -80,50 +109,18 @@ int push(MinHeap *heap, int value) {
  *
  * @param heap A pointer to the min heap.
  * @return A pointer to an integer denoting the value removed, or `NULL` if the
- *   min heap was already empty.
+ *   min heap was already empty. The pointer is into the heap's own array, so
+ *   it is only valid until the next call that adds values or resizes the array
+ *   (`push`, `pushMany`, `reserve` or `shrinkToFit`).
  */
 int *pop(MinHeap *heap) {
-  if (isEmpty(heap))
+  int min;
+  if (MinHeapPop(heap, &min))
     return NULL;
 
-  // Save return value
-  int min = heap->array[0];
-
-  heap->length--;
-
-  if (heap->length == 0) {
-    int *ptr = &min;
-    return ptr;
-  }
-
-  // Rebalance the heap by moving the last element into the root position, then
-  // continuing to swap it with its least-valued child until it is greater than
-  // both children or it reaches the last level of the tree
-  int currentIdx = 0;
-  int child1Idx = 2 * currentIdx + 1;
-  int child2Idx = 2 * currentIdx + 2;
-  int value = heap->array[heap->length];
-  while ((child1Idx < heap->length && value > heap->array[child1Idx]) ||
-         (child2Idx < heap->length && value > heap->array[child2Idx])) {
-    if (child2Idx >= heap->length ||
-        heap->array[child1Idx] < heap->array[child2Idx]) {
-      // Swap with child 1
-      heap->array[currentIdx] = heap->array[child1Idx];
-      currentIdx = child1Idx;
-    } else {
-      // Swap with child 2
-      heap->array[currentIdx] = heap->array[child2Idx];
-      currentIdx = child2Idx;
-    }
-
-    child1Idx = 2 * currentIdx + 1;
-    child2Idx = 2 * currentIdx + 2;
-  }
-
-  heap->array[currentIdx] = value;
-
-  int *ptr = &min;
-  return ptr;
+  // Keep the removed value in the slot the heap just gave up
+  heap->array[heap->length] = min;
+  return &heap->array[heap->length];
 }
 
 /**
@@ -132,62 +129,95 @@ int *pop(MinHeap *heap) {
  *
  * @param heap A pointer to the min heap.
  * @return `NULL` if the heap is currently empty; otherwise, a pointer to the
- *   first element of the array of values. Take care not to attempt to access
- *   array members at indices of `heap->length` or greater, as this will produce
- *   garbage values.
+ *   heap's own internal array, valid until the heap is next modified. Take
+ *   care not to attempt to access array members at indices of `heap->length`
+ *   or greater, as this will produce garbage values.
  */
 int *print(MinHeap *heap) {
   if (isEmpty(heap))
     return NULL;
 
-  int array[heap->length];
-  for (int i = 0; i < heap->length; i++) {
-    array[i] = heap->array[i];
-  }
-
-  int *ptr = array;
-  return ptr;
+  return heap->array;
 }
 
 /** Clears the contents of a min heap. */
-void clear(MinHeap *heap) { heap->length = 0; }
-
-/** Creates a deep clone of a min heap. */
-MinHeap *clone(MinHeap *original) {
-  MinHeap *clone = newMinHeap(original->maxSize);
-  clone->length = original->length;
-  for (int i = 0; i < original->length; i++) {
-    clone->array[i] = original->array[i];
-  }
+void clear(MinHeap *heap) { MinHeapClear(heap); }
 
-  return clone;
-}
+/**
+ * Creates a deep clone of a min heap.
+ *
+ * @return A pointer to the clone, or `NULL` if memory couldn't be allocated.
+ */
+MinHeap *clone(MinHeap *original) { return MinHeapClone(original); }
 
 /**
- * Returns a pointer to an array of all values in a min heap ordered from least
- * to greatest.
+ * Writes all values in a min heap into a caller-supplied buffer, ordered from
+ * least to greatest, leaving the heap unchanged. The copy is sorted in place
+ * with heapsort, so no memory is allocated.
  *
  * @param heap A pointer to the min heap.
- * @return `NULL` if the heap is currently empty; otherwise, a pointer to the
- *   first element of the array of values. Take care not to attempt to access
- *   array members at indices of `heap->length` or greater, as this will produce
- *   garbage values.
+ * @param buffer A pointer to an array with room for at least `heap->length`
+ *   values.
+ * @return The number of values written.
  */
-int *sort(MinHeap *heap) {
-  if (isEmpty(heap))
-    return NULL;
+int sort(MinHeap *heap, int *buffer) { return MinHeapSort(heap, buffer); }
+
+/**
+ * Removes the `k` least values from a min heap into a caller-supplied buffer,
+ * ordered from least to greatest. Only `k` values are popped, so this takes
+ * O(k log n) time rather than sorting the whole heap.
+ *
+ * @param heap A pointer to the min heap.
+ * @param k The number of values to remove.
+ * @param buffer A pointer to an array with room for at least `k` values.
+ * @return The number of values written, which will be less than `k` if the
+ *   heap runs out of values.
+ */
+int topK(MinHeap *heap, int k, int *buffer) {
+  int count = 0;
+  while (count < k && !isEmpty(heap)) {
+    buffer[count++] = *pop(heap);
+  }
 
-  MinHeap *copy = clone(heap);
+  return count;
+}
 
-  int sorted[heap->length];
-  for (int i = 0; i < heap->length; i++) {
-    sorted[i] = *pop(copy);
+/**
+ * Finds the `k` least values in a stream of values, ordered from least to
+ * greatest, in O(n log k) time. The caller's buffer doubles as a bounded max
+ * heap of the `k` least values seen so far, whose root is the first to be
+ * evicted by a smaller value, so no memory is allocated.
+ *
+ * @param values A pointer to the first value of the stream.
+ * @param count The number of values in the stream.
+ * @param k The number of values to find.
+ * @param buffer A pointer to an array with room for at least `k` values.
+ * @return The number of values written, which will be less than `k` if the
+ *   stream has fewer than `k` values.
+ */
+int nsmallest(int *values, int count, int k, int *buffer) {
+  if (k <= 0)
+    return 0;
+
+  int length = 0;
+  for (int i = 0; i < count; i++) {
+    if (length < k) {
+      // Push onto the bounded max heap
+      BoundedMaxHeapSiftUp(buffer, length++, values[i]);
+    } else if (values[i] < buffer[0]) {
+      // Evict the greatest of the values kept so far
+      BoundedMaxHeapSiftDown(buffer, length, 0, values[i]);
+    }
   }
 
-  free(copy);
+  // Heapsort the max heap in place, which orders it from least to greatest
+  for (int end = length - 1; end > 0; end--) {
+    int root = buffer[0];
+    BoundedMaxHeapSiftDown(buffer, end, 0, buffer[end]);
+    buffer[end] = root;
+  }
 
-  int *ptr = sorted;
-  return ptr;
+  return length;
 }
 
 int main() {
@@ -227,7 +257,8 @@ int main() {
     assert(unsorted[i] >= unsorted[(i - 1) / 2]);
   }
 
-  int *sorted = sort(h);
+  int sorted[10];
+  assert(sort(h, sorted) == 10);
   assert(sorted[0] == minValue);
   // Test sorting
   for (int i = 1; i < 10; i++) {
@@ -241,9 +272,88 @@ int main() {
   assert(length(h) == 0);
   assert(isEmpty(h));
   assert(print(h) == NULL);
-  assert(sort(h) == NULL);
+  assert(sort(h, sorted) == 0);
+
+  destroy(h);
+
+  // Building from an array and adding batches keep the heap property
+  int values[1000];
+  for (int i = 0; i < 1000; i++) {
+    values[i] = rand() % 1000;
+  }
+  assert(newMinHeapFromArray(values, 10, 5) == NULL);
+  h = newMinHeapFromArray(values, 100, 1000);
+  assert(length(h) == 100);
+  assert(pushMany(h, values + 100, 5) == 0);
+  assert(pushMany(h, values + 105, 895) == 0);
+  assert(isFull(h));
+  assert(pushMany(h, values, 1) == 1);
+  for (int i = 1; i < 1000; i++) {
+    assert(h->array[i] >= h->array[(i - 1) / 2]);
+  }
+  int previous = *pop(h);
+  while (!isEmpty(h)) {
+    int value = *pop(h);
+    assert(value >= previous);
+    previous = value;
+  }
 
-  free(h);
+  destroy(h);
+
+  // Partial sorts only take as many values as needed
+  h = newMinHeapFromArray(values, 1000, 1000);
+  int sortedValues[1000];
+  sort(h, sortedValues);
+  int least[10];
+  assert(topK(h, 10, least) == 10);
+  assert(length(h) == 990);
+  for (int i = 0; i < 10; i++) {
+    assert(least[i] == sortedValues[i]);
+  }
+  clear(h);
+  push(h, 4);
+  assert(topK(h, 10, least) == 1);
+  assert(least[0] == 4);
+
+  assert(nsmallest(values, 1000, 10, least) == 10);
+  for (int i = 0; i < 10; i++) {
+    assert(least[i] == sortedValues[i]);
+  }
+  assert(nsmallest(values, 3, 10, least) == 3);
+  assert(least[0] <= least[1] && least[1] <= least[2]);
+  assert(nsmallest(values, 1000, 0, least) == 0);
+
+  destroy(h);
+
+  // Heaps grow on demand up to their maximum size, and shrink back on request
+  h = newMinHeap(INT_MAX);
+  assert(h->capacity == HEAP_INITIAL_CAPACITY);
+  for (int i = 0; i < 100000; i++) {
+    assert(push(h, values[i % 1000]) == 0);
+  }
+  assert(h->capacity >= 100000 && h->capacity < 200000);
+  for (int i = 1; i < 100000; i++) {
+    assert(h->array[i] >= h->array[(i - 1) / 2]);
+  }
+  while (length(h) > 10) {
+    pop(h);
+  }
+  shrinkToFit(h);
+  assert(h->capacity == 10);
+  MinHeap *copy = clone(h);
+  assert(copy->length == 10 && copy->maxSize == INT_MAX);
+  assert(memcmp(copy->array, h->array, 10 * sizeof(int)) == 0);
+  destroy(copy);
+  assert(reserve(h, 50) == 0);
+  assert(h->capacity == 50);
+  destroy(h);
+
+  h = newMinHeap(20);
+  assert(reserve(h, 21) == 1);
+  assert(pushMany(h, values, 20) == 0);
+  assert(h->capacity == 20);
+  assert(isFull(h));
+  destroy(h);
   printf("All tests passed successfully.\n");
 
   return 0;
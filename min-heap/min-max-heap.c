@@ -0,0 +1,361 @@
+#include <assert.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * A min-max heap implemented as an implicit data structure, giving access to
+ * both the least and the greatest value from a single array. As in a binary
+ * heap, the children of the element at index `i` are located at `2 * i + 1`
+ * and `2 * i + 2`, and its parent at `(i - 1) / 2`. Levels of the tree
+ * alternate between min levels (starting with the root) and max levels: every
+ * element on a min level is less than or equal to all of its descendants, and
+ * every element on a max level is greater than or equal to all of its
+ * descendants. The least value is therefore at the root, and the greatest is
+ * one of the root's children.
+ */
+typedef struct MinMaxHeap {
+  int maxSize;
+  int length;
+  int array[];
+} MinMaxHeap;
+
+/**
+ * Constructs a new instance of a min-max heap and returns a pointer to it.
+ * (Make sure to `free` the pointer once you're finished with it.)
+ */
+MinMaxHeap *newMinMaxHeap(int maxSize) {
+  if (maxSize < 1) {
+    printf("Error: maximum size must be positive.\n");
+    return NULL;
+  }
+
+  MinMaxHeap *ptr = malloc(sizeof(MinMaxHeap) + maxSize * sizeof(int));
+
+  ptr->maxSize = maxSize;
+  ptr->length = 0;
+
+  return ptr;
+}
+
+/** Returns the number of values in a min-max heap. */
+int length(MinMaxHeap *heap) { return heap->length; }
+
+/** Returns whether or not a min-max heap is empty. */
+bool isEmpty(MinMaxHeap *heap) { return length(heap) == 0; }
+
+/** Returns whether or not a min-max heap is full. */
+bool isFull(MinMaxHeap *heap) { return length(heap) == heap->maxSize; }
+
+/** Returns whether the element at a given index lies on a min level. */
+static bool isMinLevel(int index) {
+  // The level of index `i` is floor(log2(i + 1)), and the root's is 0
+  return (31 - __builtin_clz(index + 1)) % 2 == 0;
+}
+
+/**
+ * Returns whether value `a` belongs above value `b` on the level of a given
+ * index: `a < b` on min levels, `a > b` on max levels.
+ */
+static bool comesBefore(bool minLevel, int a, int b) {
+  return minLevel ? a < b : a > b;
+}
+
+/**
+ * Moves a value up from a given index past its grandparents, which all lie on
+ * the same kind of level, until it no longer comes before its grandparent.
+ */
+static void bubbleUpGrandparents(MinMaxHeap *heap, int currentIdx, int value) {
+  bool minLevel = isMinLevel(currentIdx);
+  while (currentIdx > 2) {
+    int grandparentIdx = (currentIdx - 3) / 4;
+    if (!comesBefore(minLevel, value, heap->array[grandparentIdx]))
+      break;
+
+    heap->array[currentIdx] = heap->array[grandparentIdx];
+    currentIdx = grandparentIdx;
+  }
+
+  heap->array[currentIdx] = value;
+}
+
+/**
+ * Places a value in a min-max heap's array at a given index, then moves it
+ * down until neither its children nor its grandchildren come before it.
+ * Moving past a grandchild can leave the value on the wrong side of that
+ * grandchild's parent, in which case the two are swapped before continuing.
+ */
+static void trickleDown(MinMaxHeap *heap, int currentIdx, int value) {
+  bool minLevel = isMinLevel(currentIdx);
+  int *array = heap->array;
+
+  while (2 * currentIdx + 1 < heap->length) {
+    // Find the child or grandchild that comes first
+    int firstIdx = 2 * currentIdx + 1;
+    int candidates[] = {firstIdx + 1, 4 * currentIdx + 3, 4 * currentIdx + 4,
+                        4 * currentIdx + 5, 4 * currentIdx + 6};
+    for (int i = 0; i < 5 && candidates[i] < heap->length; i++) {
+      if (comesBefore(minLevel, array[candidates[i]], array[firstIdx]))
+        firstIdx = candidates[i];
+    }
+
+    if (!comesBefore(minLevel, array[firstIdx], value))
+      break;
+
+    bool isChild = firstIdx <= 2 * currentIdx + 2;
+    array[currentIdx] = array[firstIdx];
+    currentIdx = firstIdx;
+
+    // A child lies on the opposite kind of level, so the value has settled
+    if (isChild)
+      break;
+
+    // Keep the value on the right side of its new parent
+    int parentIdx = (currentIdx - 1) / 2;
+    if (comesBefore(minLevel, array[parentIdx], value)) {
+      int swapped = array[parentIdx];
+      array[parentIdx] = value;
+      value = swapped;
+    }
+  }
+
+  array[currentIdx] = value;
+}
+
+/**
+ * Adds a value to a min-max heap, maintaining the min-max heap property.
+ *
+ * @param heap A pointer to the min-max heap.
+ * @param value The value to add.
+ * @return `0` if the value was successfully added, `1` if the min-max heap was
+ *   already at maximum capacity (stack overflow).
+ */
+int push(MinMaxHeap *heap, int value) {
+  if (isFull(heap)) {
+    printf("Error: stack overflow: heap is already at maximum capacity.\n");
+    return 1;
+  }
+
+  int currentIdx = heap->length++;
+  if (currentIdx == 0) {
+    heap->array[0] = value;
+    return 0;
+  }
+
+  // If the value belongs on the parent's side, swap it with the parent first
+  int parentIdx = (currentIdx - 1) / 2;
+  if (comesBefore(!isMinLevel(currentIdx), value, heap->array[parentIdx])) {
+    heap->array[currentIdx] = heap->array[parentIdx];
+    currentIdx = parentIdx;
+  }
+
+  bubbleUpGrandparents(heap, currentIdx, value);
+  return 0;
+}
+
+/** Returns the index of the greatest value in a non-empty min-max heap. */
+static int maxIndex(MinMaxHeap *heap) {
+  if (heap->length == 1)
+    return 0;
+  if (heap->length == 2 || heap->array[1] >= heap->array[2])
+    return 1;
+  return 2;
+}
+
+/**
+ * Returns a pointer to the least value in a min-max heap (or `NULL` if the
+ * heap is empty), leaving it in place.
+ */
+int *peekMin(MinMaxHeap *heap) {
+  if (isEmpty(heap))
+    return NULL;
+
+  return &heap->array[0];
+}
+
+/**
+ * Returns a pointer to the greatest value in a min-max heap (or `NULL` if the
+ * heap is empty), leaving it in place.
+ */
+int *peekMax(MinMaxHeap *heap) {
+  if (isEmpty(heap))
+    return NULL;
+
+  return &heap->array[maxIndex(heap)];
+}
+
+/** Removes the value at a given index, filling the hole with the last value. */
+static int removeIndex(MinMaxHeap *heap, int index) {
+  int removed = heap->array[index];
+  heap->length--;
+  if (index < heap->length)
+    trickleDown(heap, index, heap->array[heap->length]);
+
+  return removed;
+}
+
+/**
+ * Removes the least value from a min-max heap.
+ *
+ * @param heap A pointer to the min-max heap.
+ * @param value A pointer that will receive the value removed.
+ * @return `0` if a value was successfully removed, `1` if the heap was already
+ *   empty.
+ */
+int popMin(MinMaxHeap *heap, int *value) {
+  if (isEmpty(heap))
+    return 1;
+
+  *value = removeIndex(heap, 0);
+  return 0;
+}
+
+/**
+ * Removes the greatest value from a min-max heap.
+ *
+ * @param heap A pointer to the min-max heap.
+ * @param value A pointer that will receive the value removed.
+ * @return `0` if a value was successfully removed, `1` if the heap was already
+ *   empty.
+ */
+int popMax(MinMaxHeap *heap, int *value) {
+  if (isEmpty(heap))
+    return 1;
+
+  *value = removeIndex(heap, maxIndex(heap));
+  return 0;
+}
+
+/**
+ * Offers a value to a min-max heap used as a bounded buffer of the greatest
+ * values seen so far. While the heap has room, the value is simply added; once
+ * it is full, the value replaces the least value held if it is greater, and is
+ * discarded otherwise. (Flip the signs of the values to keep the least values
+ * instead.)
+ *
+ * @param heap A pointer to the min-max heap.
+ * @param value The value to offer.
+ * @return Whether or not the value was kept.
+ */
+bool offer(MinMaxHeap *heap, int value) {
+  if (!isFull(heap)) {
+    push(heap, value);
+    return true;
+  }
+
+  if (value <= heap->array[0])
+    return false;
+
+  // Evict the least value in place rather than popping and pushing
+  trickleDown(heap, 0, value);
+  return true;
+}
+
+/** Clears the contents of a min-max heap. */
+void clear(MinMaxHeap *heap) { heap->length = 0; }
+
+/** Checks the min-max heap property over a whole min-max heap. */
+static bool isValid(MinMaxHeap *heap) {
+  for (int i = 1; i < heap->length; i++) {
+    // Every ancestor on a min level is no greater, and on a max level no less
+    for (int j = (i - 1) / 2;; j = (j - 1) / 2) {
+      if (comesBefore(isMinLevel(j), heap->array[i], heap->array[j]))
+        return false;
+      if (j == 0)
+        break;
+    }
+  }
+
+  return true;
+}
+
+int main() {
+  assert(newMinMaxHeap(0) == NULL);
+
+  MinMaxHeap *h = newMinMaxHeap(10);
+  int value;
+
+  assert(isEmpty(h));
+  assert(peekMin(h) == NULL);
+  assert(peekMax(h) == NULL);
+  assert(popMin(h, &value) == 1);
+  assert(popMax(h, &value) == 1);
+
+  push(h, 5);
+  assert(*peekMin(h) == 5 && *peekMax(h) == 5);
+  push(h, 9);
+  assert(*peekMin(h) == 5 && *peekMax(h) == 9);
+  push(h, 1);
+  assert(*peekMin(h) == 1 && *peekMax(h) == 9);
+
+  int values[] = {7, 3, 8, 2, 6, 4, 10};
+  for (int i = 0; i < 7; i++) {
+    assert(push(h, values[i]) == 0);
+    assert(isValid(h));
+  }
+  assert(isFull(h));
+  assert(push(h, 0) == 1);
+
+  // Pop alternately from both ends
+  for (int i = 0; i < 5; i++) {
+    assert(popMin(h, &value) == 0 && value == i + 1);
+    assert(isValid(h));
+    assert(popMax(h, &value) == 0 && value == 10 - i);
+    assert(isValid(h));
+  }
+  assert(isEmpty(h));
+
+  // Random values come out sorted from either end
+  free(h);
+  h = newMinMaxHeap(1000);
+  for (int i = 0; i < 1000; i++) {
+    push(h, rand() % 500);
+  }
+  assert(isValid(h));
+
+  int low = INT_MIN;
+  int high = INT_MAX;
+  for (int i = 0; i < 500; i++) {
+    assert(popMin(h, &value) == 0 && value >= low);
+    low = value;
+    assert(popMax(h, &value) == 0 && value <= high);
+    high = value;
+    assert(low <= high);
+  }
+  assert(isEmpty(h));
+  free(h);
+
+  // A bounded buffer keeps the greatest values, evicting from the worst end
+  h = newMinMaxHeap(5);
+  int counts[100] = {0};
+  for (int i = 0; i < 100; i++) {
+    counts[i] = rand() % 100;
+    offer(h, counts[i]);
+    assert(isValid(h));
+  }
+  assert(!offer(h, -1));
+
+  // Compare against the five greatest values found by sorting
+  for (int i = 0; i < 100; i++) {
+    for (int j = i + 1; j < 100; j++) {
+      if (counts[j] > counts[i]) {
+        int swapped = counts[i];
+        counts[i] = counts[j];
+        counts[j] = swapped;
+      }
+    }
+  }
+  for (int i = 0; i < 5; i++) {
+    assert(popMax(h, &value) == 0 && value == counts[i]);
+  }
+
+  push(h, 1);
+  clear(h);
+  assert(length(h) == 0);
+
+  free(h);
+  printf("All tests passed successfully.\n");
+
+  return 0;
+}
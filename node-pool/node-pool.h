@@ -0,0 +1,131 @@
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/** A block of memory holding many nodes, linked to the next slab allocated. */
+typedef struct Slab {
+  struct Slab *next;
+  _Alignas(max_align_t) char nodes[];
+} Slab;
+
+/** A node that has been given back to a pool, linked to the next such node. */
+typedef struct FreeNode {
+  struct FreeNode *next;
+} FreeNode;
+
+/**
+ * A pool of fixed-size nodes, carved out of large slabs instead of being
+ * allocated one by one. Freed nodes go onto a free list and are reused first;
+ * otherwise nodes are handed out in order from the current slab, so a freshly
+ * built list lies sequentially in memory. Resetting the pool takes every node
+ * back at once in O(1) time while keeping its slabs for reuse.
+ *
+ * A pool can be owned by a single list or shared by several lists whose nodes
+ * have the same size.
+ */
+typedef struct NodePool {
+  size_t nodeSize;
+  int nodesPerSlab;
+  Slab *slabs;       // Every slab allocated, in order
+  Slab *currentSlab; // The slab new nodes are carved from
+  int nextNode;      // The index of the next unused node in the current slab
+  FreeNode *freeList;
+} NodePool;
+
+/**
+ * Constructs a new node pool and returns a pointer to it. No memory is
+ * allocated for nodes until the first one is requested. (Make sure to
+ * `destroyNodePool` the pool once you're finished with it.)
+ *
+ * @param nodeSize The size of each node in bytes.
+ * @param nodesPerSlab The number of nodes to allocate at a time.
+ */
+static inline NodePool *newNodePool(size_t nodeSize, int nodesPerSlab) {
+  if (nodesPerSlab < 1) {
+    printf("Error: nodes per slab must be positive.\n");
+    return NULL;
+  }
+
+  NodePool *ptr = malloc(sizeof(NodePool));
+
+  // Round up so that every node in a slab stays aligned
+  size_t alignment = _Alignof(max_align_t);
+  if (nodeSize < sizeof(FreeNode))
+    nodeSize = sizeof(FreeNode);
+  ptr->nodeSize = (nodeSize + alignment - 1) / alignment * alignment;
+  ptr->nodesPerSlab = nodesPerSlab;
+  ptr->slabs = NULL;
+  ptr->currentSlab = NULL;
+  ptr->nextNode = nodesPerSlab;
+  ptr->freeList = NULL;
+
+  return ptr;
+}
+
+/**
+ * Takes a node from a node pool, reusing a freed node if there is one, and
+ * otherwise the next unused node of the current slab (moving on to the next
+ * slab, or allocating a new one, when it runs out).
+ *
+ * @return A pointer to an uninitialized node.
+ */
+static inline void *poolAlloc(NodePool *pool) {
+  if (pool->freeList) {
+    FreeNode *node = pool->freeList;
+    pool->freeList = node->next;
+    return node;
+  }
+
+  if (pool->nextNode == pool->nodesPerSlab) {
+    Slab *slab = pool->currentSlab ? pool->currentSlab->next : pool->slabs;
+    if (!slab) {
+      slab = malloc(sizeof(Slab) + pool->nodesPerSlab * pool->nodeSize);
+      slab->next = NULL;
+      if (pool->currentSlab) {
+        pool->currentSlab->next = slab;
+      } else {
+        pool->slabs = slab;
+      }
+    }
+
+    pool->currentSlab = slab;
+    pool->nextNode = 0;
+  }
+
+  return pool->currentSlab->nodes + pool->nextNode++ * pool->nodeSize;
+}
+
+/** Gives a node back to the node pool it was taken from, for reuse. */
+static inline void poolFree(NodePool *pool, void *node) {
+  FreeNode *freeNode = node;
+  freeNode->next = pool->freeList;
+  pool->freeList = freeNode;
+}
+
+/**
+ * Takes back every node of a node pool at once, keeping its slabs to be
+ * reused from the start. Any node previously taken from the pool must no
+ * longer be used.
+ */
+static inline void poolReset(NodePool *pool) {
+  pool->currentSlab = NULL;
+  pool->nextNode = pool->nodesPerSlab;
+  pool->freeList = NULL;
+}
+
+/** Frees the allocated memory for a node pool and every node in it. */
+static inline void destroyNodePool(NodePool *pool) {
+  Slab *slab = pool->slabs;
+  while (slab) {
+    Slab *nextSlab = slab->next;
+    free(slab);
+    slab = nextSlab;
+  }
+
+  free(pool);
+}
+
+#endif
@@ -0,0 +1,267 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct QueueItem {
+  char *element;
+  int next; // Index of the next item in the same bucket, or `-1`
+} QueueItem;
+
+typedef struct Bucket {
+  int head; // `-1` when the bucket is empty
+  int tail;
+} Bucket;
+
+/**
+ * A priority queue for small, bounded integer priorities (from `0` through
+ * `maxPriority`). Items will be ordered first in descending order of priority,
+ * then in descending order of length of time in the queue.
+ *
+ * Each priority has its own bucket: a first-in-first-out chain of items linked
+ * by index through `array`. A bitmap records which buckets are non-empty, so
+ * the highest non-empty bucket is found with a count-leading-zeros instruction
+ * per 64 priorities rather than by comparing items. Enqueueing and dequeueing
+ * are O(1) for up to 64 priorities.
+ */
+typedef struct BucketPriorityQueue {
+  int maxSize;
+  int length;
+  int maxPriority;
+  int freeItem; // Head of the chain of unused items in `array`, or `-1`
+  Bucket *buckets;
+  uint64_t *nonEmpty; // Bit `p` is set if bucket `p` has items
+  QueueItem array[];
+} BucketPriorityQueue;
+
+/** Returns the number of 64-bit words in a bucket priority queue's bitmap. */
+static int numWords(int maxPriority) { return maxPriority / 64 + 1; }
+
+/** Clears the contents of a bucket priority queue. */
+void clear(BucketPriorityQueue *queue) {
+  queue->length = 0;
+
+  for (int p = 0; p <= queue->maxPriority; p++) {
+    queue->buckets[p] = (Bucket){-1, -1};
+  }
+  memset(queue->nonEmpty, 0, numWords(queue->maxPriority) * sizeof(uint64_t));
+
+  // Chain every item together as unused
+  for (int i = 0; i < queue->maxSize; i++) {
+    queue->array[i].next = i + 1 < queue->maxSize ? i + 1 : -1;
+  }
+  queue->freeItem = 0;
+}
+
+/**
+ * Constructs a new instance of a bucket priority queue and returns a pointer to
+ * it. (Make sure to `destroy` the queue once you're finished with it.)
+ */
+BucketPriorityQueue *newBucketPriorityQueue(int maxSize, int maxPriority) {
+  if (maxSize < 1) {
+    printf("Error: maximum size must be positive.\n");
+    return NULL;
+  }
+  if (maxPriority < 0) {
+    printf("Error: maximum priority must not be negative.\n");
+    return NULL;
+  }
+
+  BucketPriorityQueue *ptr =
+      malloc(sizeof(BucketPriorityQueue) + maxSize * sizeof(QueueItem));
+
+  ptr->maxSize = maxSize;
+  ptr->maxPriority = maxPriority;
+  ptr->buckets = malloc((maxPriority + 1) * sizeof(Bucket));
+  ptr->nonEmpty = malloc(numWords(maxPriority) * sizeof(uint64_t));
+  clear(ptr);
+
+  return ptr;
+}
+
+/** Returns the number of elements in a bucket priority queue. */
+int size(BucketPriorityQueue *queue) { return queue->length; }
+
+/** Returns whether or not a bucket priority queue is empty. */
+bool isEmpty(BucketPriorityQueue *queue) { return size(queue) == 0; }
+
+/** Returns whether or not a bucket priority queue is full. */
+bool isFull(BucketPriorityQueue *queue) {
+  return size(queue) == queue->maxSize;
+}
+
+/**
+ * Returns the highest priority with a non-empty bucket in a bucket priority
+ * queue, or `-1` if the queue is empty.
+ */
+static int highestPriority(BucketPriorityQueue *queue) {
+  for (int w = numWords(queue->maxPriority) - 1; w >= 0; w--) {
+    if (queue->nonEmpty[w])
+      return w * 64 + 63 - __builtin_clzll(queue->nonEmpty[w]);
+  }
+
+  return -1;
+}
+
+/**
+ * Adds an element to a bucket priority queue behind any items of equal or
+ * higher priority.
+ *
+ * @param queue A pointer to the bucket priority queue.
+ * @param element The element to be added.
+ * @param priority The element's priority, from `0` through `maxPriority`
+ *   (higher values leave the queue first).
+ * @return `0` if the element was successfully added, `1` if the queue was
+ *   already full or the priority was out of range.
+ */
+int enqueue(BucketPriorityQueue *queue, char *element, int priority) {
+  if (isFull(queue)) {
+    printf("Enqueue error: bucket priority queue is already full.\n");
+    return 1;
+  }
+  if (priority < 0 || priority > queue->maxPriority) {
+    printf("Enqueue error: priority is out of range.\n");
+    return 1;
+  }
+
+  int index = queue->freeItem;
+  queue->freeItem = queue->array[index].next;
+  queue->array[index] = (QueueItem){element, -1};
+
+  Bucket *bucket = &queue->buckets[priority];
+  if (bucket->head == -1) {
+    bucket->head = index;
+    queue->nonEmpty[priority / 64] |= UINT64_C(1) << (priority % 64);
+  } else {
+    queue->array[bucket->tail].next = index;
+  }
+  bucket->tail = index;
+
+  queue->length++;
+  return 0;
+}
+
+/**
+ * Returns the element at the front of a bucket priority queue, leaving it in
+ * place.
+ *
+ * @param queue A pointer to the bucket priority queue.
+ * @return The element at the front of the queue, or `NULL` if the queue is
+ *   empty.
+ */
+char *front(BucketPriorityQueue *queue) {
+  if (isEmpty(queue)) {
+    printf("Front error: bucket priority queue is empty.\n");
+    return NULL;
+  }
+
+  return queue->array[queue->buckets[highestPriority(queue)].head].element;
+}
+
+/**
+ * Removes and returns the element at the front of a bucket priority queue.
+ *
+ * @param queue A pointer to the bucket priority queue.
+ * @return The element removed, or `NULL` if the queue was already empty.
+ */
+char *dequeue(BucketPriorityQueue *queue) {
+  if (isEmpty(queue)) {
+    printf("Dequeue error: bucket priority queue is already empty.\n");
+    return NULL;
+  }
+
+  int priority = highestPriority(queue);
+  Bucket *bucket = &queue->buckets[priority];
+  int index = bucket->head;
+
+  bucket->head = queue->array[index].next;
+  if (bucket->head == -1)
+    queue->nonEmpty[priority / 64] &= ~(UINT64_C(1) << (priority % 64));
+
+  // Return the item to the unused chain
+  char *dequeued = queue->array[index].element;
+  queue->array[index].next = queue->freeItem;
+  queue->freeItem = index;
+
+  queue->length--;
+  return dequeued;
+}
+
+/** Frees the allocated memory for a bucket priority queue. */
+void destroy(BucketPriorityQueue *queue) {
+  free(queue->buckets);
+  free(queue->nonEmpty);
+  free(queue);
+}
+
+/**
+ * Prints a bucket priority queue to the console as comma-separated [element,
+ * priority] tuples, ordered from front to end.
+ */
+void print(BucketPriorityQueue *queue) {
+  bool first = true;
+  for (int p = queue->maxPriority; p >= 0; p--) {
+    for (int i = queue->buckets[p].head; i != -1; i = queue->array[i].next) {
+      printf(first ? "[\"%s\", %d]" : ", [\"%s\", %d]", queue->array[i].element,
+             p);
+      first = false;
+    }
+  }
+  printf("\n");
+}
+
+int main() {
+  assert(newBucketPriorityQueue(0, 10) == NULL);
+  assert(newBucketPriorityQueue(5, -1) == NULL);
+
+  BucketPriorityQueue *q = newBucketPriorityQueue(5, 100);
+
+  print(q);
+  assert(isEmpty(q));
+  assert(dequeue(q) == NULL);
+  assert(front(q) == NULL);
+
+  assert(enqueue(q, "this", 9) == 0);
+  enqueue(q, "air", 3);
+  enqueue(q, "elephant", 12);
+  print(q);
+  assert(strcmp(front(q), "elephant") == 0);
+  assert(size(q) == 3);
+  assert(!isFull(q));
+  assert(enqueue(q, "too high", 101) == 1);
+  assert(enqueue(q, "too low", -1) == 1);
+
+  enqueue(q, "forge", 3);
+  enqueue(q, "elbow", 90);
+  assert(isFull(q));
+  assert(enqueue(q, "not gonna happen", 0) == 1);
+
+  print(q);
+  assert(strcmp(dequeue(q), "elbow") == 0);
+  assert(strcmp(dequeue(q), "elephant") == 0);
+  assert(strcmp(dequeue(q), "this") == 0);
+  assert(strcmp(dequeue(q), "air") == 0);
+  assert(strcmp(dequeue(q), "forge") == 0);
+  assert(isEmpty(q));
+
+  // Items are reused once they leave the queue
+  for (int round = 0; round < 3; round++) {
+    enqueue(q, "low", 0);
+    enqueue(q, "high", 64);
+    assert(strcmp(dequeue(q), "high") == 0);
+    assert(strcmp(front(q), "low") == 0);
+    dequeue(q);
+  }
+
+  enqueue(q, "kept", 1);
+  clear(q);
+  assert(isEmpty(q));
+  assert(front(q) == NULL);
+
+  destroy(q);
+  printf("All tests passed successfully.\n");
+
+  return 0;
+}
@@ -0,0 +1,305 @@
+#include <assert.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct Item {
+  int key;
+  int value;
+} Item;
+
+/**
+ * A binary min heap of items guarded by its own lock. `topKey` mirrors the key
+ * at the root (or `INT_MAX` when the heap is empty) so that other threads can
+ * compare heaps without taking their locks. Each heap is aligned to its own
+ * cache line to keep threads working on neighboring heaps from contending.
+ */
+typedef struct LockedHeap {
+  _Alignas(64) pthread_mutex_t lock;
+  _Atomic int topKey;
+  int maxSize;
+  int length;
+  Item *array;
+} LockedHeap;
+
+/**
+ * A MultiQueue: a concurrent, relaxed min priority queue made of several
+ * independent locked heaps. Pushes go to a random heap, and pops take the
+ * smaller root of two random heaps, skipping any heap that another thread has
+ * locked rather than waiting for it. Pops aren't guaranteed to return the
+ * overall least key, but they return keys close to it, and threads rarely
+ * contend with each other as long as there are several heaps per thread.
+ */
+typedef struct MultiQueue {
+  int numHeaps;
+  _Atomic int length;
+  LockedHeap heaps[];
+} MultiQueue;
+
+/**
+ * Constructs a new instance of a MultiQueue and returns a pointer to it. (Make
+ * sure to `destroy` the MultiQueue once you're finished with it.)
+ *
+ * @param numThreads The number of threads that will use the MultiQueue.
+ * @param heapsPerThread The number of heaps to create per thread (usually 2 to
+ *   4); more heaps mean less contention but looser ordering.
+ * @param maxHeapSize The maximum number of items each heap can hold.
+ */
+MultiQueue *newMultiQueue(int numThreads, int heapsPerThread, int maxHeapSize) {
+  if (numThreads < 1 || heapsPerThread < 1 || maxHeapSize < 1) {
+    printf("Error: threads, heaps per thread and heap size must be "
+           "positive.\n");
+    return NULL;
+  }
+
+  int numHeaps = numThreads * heapsPerThread;
+  if (numHeaps < 2)
+    numHeaps = 2;
+
+  MultiQueue *ptr;
+  if (posix_memalign((void **)&ptr, 64,
+                     sizeof(MultiQueue) + numHeaps * sizeof(LockedHeap)))
+    return NULL;
+
+  ptr->numHeaps = numHeaps;
+  atomic_init(&ptr->length, 0);
+  for (int i = 0; i < numHeaps; i++) {
+    LockedHeap *heap = &ptr->heaps[i];
+    pthread_mutex_init(&heap->lock, NULL);
+    atomic_init(&heap->topKey, INT_MAX);
+    heap->maxSize = maxHeapSize;
+    heap->length = 0;
+    heap->array = malloc(maxHeapSize * sizeof(Item));
+  }
+
+  return ptr;
+}
+
+/** Frees the allocated memory for a MultiQueue. */
+void destroy(MultiQueue *queue) {
+  for (int i = 0; i < queue->numHeaps; i++) {
+    pthread_mutex_destroy(&queue->heaps[i].lock);
+    free(queue->heaps[i].array);
+  }
+  free(queue);
+}
+
+/**
+ * Returns the number of items in a MultiQueue (which may already be out of date
+ * if other threads are using it).
+ */
+int size(MultiQueue *queue) { return atomic_load(&queue->length); }
+
+/** Returns whether or not a MultiQueue is empty. */
+bool isEmpty(MultiQueue *queue) { return size(queue) == 0; }
+
+/** Returns a random heap index, using a per-thread xorshift generator. */
+static int randomHeap(MultiQueue *queue) {
+  static _Thread_local uint32_t state = 0;
+  if (state == 0)
+    state = (uint32_t)(uintptr_t)&state | 1;
+
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state % queue->numHeaps;
+}
+
+/** Adds an item to a locked heap that isn't full, maintaining heap order. */
+static void heapPush(LockedHeap *heap, Item item) {
+  int currentIdx = heap->length;
+  int parentIdx = (currentIdx - 1) / 2;
+  while (currentIdx > 0 && item.key < heap->array[parentIdx].key) {
+    heap->array[currentIdx] = heap->array[parentIdx];
+    currentIdx = parentIdx;
+    parentIdx = (currentIdx - 1) / 2;
+  }
+
+  heap->array[currentIdx] = item;
+  heap->length++;
+  atomic_store_explicit(&heap->topKey, heap->array[0].key,
+                        memory_order_relaxed);
+}
+
+/** Removes and returns the root of a locked heap that isn't empty. */
+static Item heapPop(LockedHeap *heap) {
+  Item min = heap->array[0];
+  heap->length--;
+
+  int currentIdx = 0;
+  Item item = heap->array[heap->length];
+  while (2 * currentIdx + 1 < heap->length) {
+    int childIdx = 2 * currentIdx + 1;
+    if (childIdx + 1 < heap->length &&
+        heap->array[childIdx + 1].key < heap->array[childIdx].key)
+      childIdx++;
+    if (item.key <= heap->array[childIdx].key)
+      break;
+
+    heap->array[currentIdx] = heap->array[childIdx];
+    currentIdx = childIdx;
+  }
+  heap->array[currentIdx] = item;
+
+  atomic_store_explicit(&heap->topKey,
+                        heap->length > 0 ? heap->array[0].key : INT_MAX,
+                        memory_order_relaxed);
+  return min;
+}
+
+/**
+ * Adds an item to a random heap of a MultiQueue. Safe to call from any number
+ * of threads at once.
+ *
+ * @param queue A pointer to the MultiQueue.
+ * @param key The item's key (lower keys are popped first).
+ * @param value The item's value.
+ * @return `0` if the item was successfully added, `1` if every heap was full.
+ */
+int push(MultiQueue *queue, int key, int value) {
+  // Pick a random heap that isn't locked by another thread
+  int start;
+  LockedHeap *heap;
+  do {
+    start = randomHeap(queue);
+    heap = &queue->heaps[start];
+  } while (pthread_mutex_trylock(&heap->lock) != 0);
+
+  // If that heap is full, look for room in the others in turn
+  for (int i = 1; heap->length == heap->maxSize; i++) {
+    pthread_mutex_unlock(&heap->lock);
+    if (i == queue->numHeaps) {
+      printf("Error: MultiQueue heaps are at maximum capacity.\n");
+      return 1;
+    }
+
+    heap = &queue->heaps[(start + i) % queue->numHeaps];
+    pthread_mutex_lock(&heap->lock);
+  }
+
+  heapPush(heap, (Item){key, value});
+  atomic_fetch_add(&queue->length, 1);
+  pthread_mutex_unlock(&heap->lock);
+  return 0;
+}
+
+/**
+ * Removes an item with a small key from a MultiQueue: the smaller root of two
+ * randomly chosen heaps. Safe to call from any number of threads at once.
+ *
+ * @param queue A pointer to the MultiQueue.
+ * @param out A pointer that will receive the item removed.
+ * @return `0` if an item was successfully removed, `1` if the MultiQueue was
+ *   empty.
+ */
+int pop(MultiQueue *queue, Item *out) {
+  while (!isEmpty(queue)) {
+    LockedHeap *first = &queue->heaps[randomHeap(queue)];
+    LockedHeap *second = &queue->heaps[randomHeap(queue)];
+    LockedHeap *heap =
+        atomic_load_explicit(&first->topKey, memory_order_relaxed) <=
+                atomic_load_explicit(&second->topKey, memory_order_relaxed)
+            ? first
+            : second;
+
+    if (pthread_mutex_trylock(&heap->lock) != 0)
+      continue;
+
+    if (heap->length == 0) {
+      pthread_mutex_unlock(&heap->lock);
+      continue;
+    }
+
+    *out = heapPop(heap);
+    atomic_fetch_sub(&queue->length, 1);
+    pthread_mutex_unlock(&heap->lock);
+    return 0;
+  }
+
+  return 1;
+}
+
+#define NUM_THREADS 4
+#define ITEMS_PER_THREAD 100000
+
+static MultiQueue *shared;
+
+static void *pushThenPop(void *arg) {
+  int thread = (int)(intptr_t)arg;
+  long long *sum = malloc(sizeof(long long));
+  *sum = 0;
+
+  for (int i = 0; i < ITEMS_PER_THREAD; i++) {
+    int value = thread * ITEMS_PER_THREAD + i;
+    assert(push(shared, value, value) == 0);
+  }
+
+  Item item;
+  while (pop(shared, &item) == 0) {
+    assert(item.key == item.value);
+    *sum += item.value;
+  }
+
+  return sum;
+}
+
+int main() {
+  assert(newMultiQueue(0, 2, 10) == NULL);
+
+  MultiQueue *q = newMultiQueue(1, 2, 4);
+  Item item;
+
+  assert(isEmpty(q));
+  assert(pop(q, &item) == 1);
+
+  // With a single thread, every item is popped exactly once
+  int keys[] = {5, 3, 8, 1, 9, 2, 7, 4};
+  for (int i = 0; i < 8; i++) {
+    assert(push(q, keys[i], i) == 0);
+  }
+  assert(size(q) == 8);
+  assert(push(q, 0, 0) == 1);
+
+  int seen = 0;
+  while (pop(q, &item) == 0) {
+    assert(keys[item.value] == item.key);
+    seen |= 1 << item.value;
+  }
+  assert(seen == 0xff);
+  assert(isEmpty(q));
+
+  destroy(q);
+
+  // Items pushed and popped from several threads are neither lost nor repeated
+  shared = newMultiQueue(NUM_THREADS, 4, ITEMS_PER_THREAD);
+  pthread_t threads[NUM_THREADS];
+  for (int t = 0; t < NUM_THREADS; t++) {
+    pthread_create(&threads[t], NULL, pushThenPop, (void *)(intptr_t)t);
+  }
+
+  long long total = 0;
+  for (int t = 0; t < NUM_THREADS; t++) {
+    long long *sum;
+    pthread_join(threads[t], (void **)&sum);
+    total += *sum;
+    free(sum);
+  }
+
+  // Pops may give up while other threads still hold items; drain the rest
+  while (pop(shared, &item) == 0) {
+    total += item.value;
+  }
+
+  long long n = (long long)NUM_THREADS * ITEMS_PER_THREAD;
+  assert(total == n * (n - 1) / 2);
+  assert(isEmpty(shared));
+
+  destroy(shared);
+  printf("All tests passed successfully.\n");
+
+  return 0;
+}
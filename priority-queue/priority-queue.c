@@ -7,19 +7,48 @@
 typedef struct QueueItem {
   char *element;
   int priority;
+  long long sequence; // Insertion order, to break ties between priorities
+  int handle;
 } QueueItem;
 
+/** The number of children of each node in a priority queue's heap. */
+#define ARITY 4
+
 /**
  * A priority queue data structure, in which items will specify their priority.
  * Items will be ordered first in descending order of priority, then in
  * descending order of length of time in the queue.
+ *
+ * Items are stored as an implicit `ARITY`-ary heap: for an item at index `i`,
+ * its children will be located at `ARITY * i + 1` through `ARITY * i + ARITY`,
+ * and its parent will be located at `(i - 1) / ARITY`. No item will come
+ * before its parent, so the front of the queue is always at index `0`.
+ *
+ * Every item is also given a handle when it is enqueued, which stays valid
+ * until the item leaves the queue. `positions` tracks where each handle's item
+ * currently sits in the heap, so items can be found and moved without a search.
  */
 typedef struct PriorityQueue {
   int maxSize;
   int end;
+  long long nextSequence;
+  int *positions;   // Heap index of each handle's item, or `-1` if unused
+  int *freeHandles; // Stack of unused handles, with `maxSize - size` entries
   QueueItem array[];
 } PriorityQueue;
 
+/** Clears the contents of a priority queue, invalidating all handles. */
+void clear(PriorityQueue *queue) {
+  queue->end = -1;
+  queue->nextSequence = 0;
+
+  // Stack the handles so that the lowest ones are handed out first
+  for (int i = 0; i < queue->maxSize; i++) {
+    queue->positions[i] = -1;
+    queue->freeHandles[i] = queue->maxSize - 1 - i;
+  }
+}
+
 /**
  * Constructs a new instance of a priority queue and returns a pointer to it.
  * (Make sure to `free` the pointer once you're finished with it.)
@@ -30,11 +59,14 @@ PriorityQueue *newPriorityQueue(int maxSize) {
     return NULL;
   }
 
-  PriorityQueue *ptr =
-      malloc(sizeof(PriorityQueue) + maxSize * sizeof(QueueItem));
+  // Keep the handle tables in the same allocation, right after the items
+  PriorityQueue *ptr = malloc(sizeof(PriorityQueue) +
+                              maxSize * (sizeof(QueueItem) + 2 * sizeof(int)));
 
   ptr->maxSize = maxSize;
-  ptr->end = -1;
+  ptr->positions = (int *)(ptr->array + maxSize);
+  ptr->freeHandles = ptr->positions + maxSize;
+  clear(ptr);
 
   return ptr;
 }
@@ -48,34 +80,168 @@ bool isEmpty(PriorityQueue *queue) { return size(queue) == 0; }
 /** Returns whether or not a priority queue is full. */
 bool isFull(PriorityQueue *queue) { return size(queue) == queue->maxSize; }
 
+/** Returns whether or not item `a` should leave a priority queue before `b`. */
+static bool comesBefore(QueueItem *a, QueueItem *b) {
+  if (a->priority != b->priority)
+    return a->priority > b->priority;
+
+  return a->sequence < b->sequence;
+}
+
+/** Stores an item at a given index of a priority queue's heap. */
+static void place(PriorityQueue *queue, int index, QueueItem item) {
+  queue->array[index] = item;
+  queue->positions[item.handle] = index;
+}
+
+/**
+ * Moves an item toward the root of a priority queue's heap until it no longer
+ * comes before its parent, then stores it at its final index.
+ */
+static void siftUp(PriorityQueue *queue, int index, QueueItem item) {
+  while (index > 0) {
+    int parentIndex = (index - 1) / ARITY;
+    if (!comesBefore(&item, &queue->array[parentIndex]))
+      break;
+
+    place(queue, index, queue->array[parentIndex]);
+    index = parentIndex;
+  }
+
+  place(queue, index, item);
+}
+
+/**
+ * Moves an item toward the leaves of a priority queue's heap until none of its
+ * children come before it, then stores it at its final index.
+ */
+static void siftDown(PriorityQueue *queue, int index, QueueItem item) {
+  int length = size(queue);
+
+  while (true) {
+    int firstChild = ARITY * index + 1;
+    if (firstChild >= length)
+      break;
+
+    // Find the child that should leave the queue first
+    int bestChild = firstChild;
+    int lastChild = firstChild + ARITY < length ? firstChild + ARITY : length;
+    for (int i = firstChild + 1; i < lastChild; i++) {
+      if (comesBefore(&queue->array[i], &queue->array[bestChild]))
+        bestChild = i;
+    }
+
+    if (!comesBefore(&queue->array[bestChild], &item))
+      break;
+
+    place(queue, index, queue->array[bestChild]);
+    index = bestChild;
+  }
+
+  place(queue, index, item);
+}
+
 /**
- * Adds an element to the end of a priority queue, then moves it in front of any
- * lower-priority items.
+ * Adds an element to a priority queue behind any items of equal or higher
+ * priority.
  *
  * @param queue A pointer to the priority queue.
  * @param element The element to be added.
- * @return `0` if the element was successfully added, `1` if the queue was
- *   already full.
+ * @param priority The element's priority (higher values leave the queue first).
+ * @return A handle for the element, valid until it leaves the queue, or `-1`
+ *   if the queue was already full.
  */
 int enqueue(PriorityQueue *queue, char *element, int priority) {
   if (isFull(queue)) {
     printf("Enqueue error: priority queue is already full.\n");
-    return 1;
+    return -1;
   }
 
-  // Move elements toward the end until the correct insert index is found
-  int insertIndex = size(queue);
-  while (insertIndex > 0 && queue->array[insertIndex - 1].priority < priority) {
-    queue->array[insertIndex] = queue->array[insertIndex - 1];
-    insertIndex--;
-  }
+  int handle = queue->freeHandles[queue->maxSize - size(queue) - 1];
 
-  queue->array[insertIndex] = (QueueItem){element, priority};
   queue->end++;
+  siftUp(queue, queue->end,
+         (QueueItem){element, priority, queue->nextSequence++, handle});
+
+  return handle;
+}
+
+/** Returns whether or not a handle refers to an item in a priority queue. */
+static bool isValidHandle(PriorityQueue *queue, int handle) {
+  return handle >= 0 && handle < queue->maxSize &&
+         queue->positions[handle] != -1;
+}
+
+/**
+ * Removes the item at a given index of a priority queue's heap, filling the gap
+ * with the last item, and releases its handle.
+ */
+static QueueItem removeIndex(PriorityQueue *queue, int index) {
+  QueueItem removed = queue->array[index];
+  QueueItem last = queue->array[queue->end];
+  queue->end--;
+
+  queue->positions[removed.handle] = -1;
+  queue->freeHandles[queue->maxSize - size(queue) - 1] = removed.handle;
+
+  if (index <= queue->end) {
+    // The last item may belong either above or below the gap
+    if (index > 0 && comesBefore(&last, &queue->array[(index - 1) / ARITY]))
+      siftUp(queue, index, last);
+    else
+      siftDown(queue, index, last);
+  }
+
+  return removed;
+}
+
+/**
+ * Changes the priority of an element already in a priority queue, moving it to
+ * its new place. Among items of equal priority, it keeps its original place in
+ * line.
+ *
+ * @param queue A pointer to the priority queue.
+ * @param handle The handle returned when the element was enqueued.
+ * @param priority The element's new priority.
+ * @return `0` if the priority was successfully changed, `1` if the handle
+ *   doesn't refer to an element in the queue.
+ */
+int updatePriority(PriorityQueue *queue, int handle, int priority) {
+  if (!isValidHandle(queue, handle)) {
+    printf("Update error: handle is not in the priority queue.\n");
+    return 1;
+  }
+
+  int index = queue->positions[handle];
+  QueueItem item = queue->array[index];
+  int oldPriority = item.priority;
+  item.priority = priority;
+
+  if (priority > oldPriority)
+    siftUp(queue, index, item);
+  else
+    siftDown(queue, index, item);
 
   return 0;
 }
 
+/**
+ * Removes an element from anywhere in a priority queue.
+ *
+ * @param queue A pointer to the priority queue.
+ * @param handle The handle returned when the element was enqueued.
+ * @return The element removed, or `NULL` if the handle doesn't refer to an
+ *   element in the queue.
+ */
+char *removeHandle(PriorityQueue *queue, int handle) {
+  if (!isValidHandle(queue, handle)) {
+    printf("Remove error: handle is not in the priority queue.\n");
+    return NULL;
+  }
+
+  return removeIndex(queue, queue->positions[handle]).element;
+}
+
 /**
  * Returns the element at the front of a priority queue, leaving it in place.
  *
@@ -104,19 +270,13 @@ char *dequeue(PriorityQueue *queue) {
     return NULL;
   }
 
-  char *dequeued = queue->array[0].element;
-
-  for (int i = 0; i < queue->end; i++) {
-    queue->array[i] = queue->array[i + 1];
-  }
-
-  queue->end--;
-
-  return dequeued;
+  return removeIndex(queue, 0).element;
 }
 
-/** Clears the contents of a priority queue. */
-void clear(PriorityQueue *queue) { queue->end = -1; }
+/** Orders queue items for `qsort`, front of the queue first. */
+static int compareItems(const void *a, const void *b) {
+  return comesBefore((QueueItem *)a, (QueueItem *)b) ? -1 : 1;
+}
 
 /**
  * Prints a priority queue to the console as comma-separated [element, priority]
@@ -124,11 +284,17 @@ void clear(PriorityQueue *queue) { queue->end = -1; }
  */
 void print(PriorityQueue *queue) {
   if (!isEmpty(queue)) {
-    printf("[\"%s\", %d]", queue->array[0].element, queue->array[0].priority);
+    // Sort a copy of the items to visit them in order
+    QueueItem *items = malloc(size(queue) * sizeof(QueueItem));
+    memcpy(items, queue->array, size(queue) * sizeof(QueueItem));
+    qsort(items, size(queue), sizeof(QueueItem), compareItems);
+
+    printf("[\"%s\", %d]", items[0].element, items[0].priority);
     for (int i = 1; i <= queue->end; i++) {
-      printf(", [\"%s\", %d]", queue->array[i].element,
-             queue->array[i].priority);
+      printf(", [\"%s\", %d]", items[i].element, items[i].priority);
     }
+
+    free(items);
   }
   printf("\n");
 }
@@ -155,13 +321,75 @@ int main() {
   enqueue(q, "forge", 4);
   enqueue(q, "elbow", 90);
   assert(isFull(q));
-  assert(enqueue(q, "not gonna happen", 0) == 1);
+  assert(enqueue(q, "not gonna happen", 0) == -1);
 
   print(q);
   clear(q);
   assert(isEmpty(q));
   assert(front(q) == NULL);
 
+  free(q);
+
+  // Items of equal priority leave in the order they arrived
+  q = newPriorityQueue(100);
+  char names[100][4];
+  for (int i = 0; i < 100; i++) {
+    snprintf(names[i], sizeof(names[i]), "%d", i);
+    enqueue(q, names[i], (i * 7) % 5);
+  }
+  int lastPriority = 4;
+  int lastIndex = -1;
+  while (!isEmpty(q)) {
+    int index = atoi(dequeue(q));
+    int priority = (index * 7) % 5;
+    assert(priority <= lastPriority);
+    if (priority == lastPriority)
+      assert(index > lastIndex);
+    lastPriority = priority;
+    lastIndex = index;
+  }
+
+  // Handles allow elements to be moved or removed in place
+  clear(q);
+  int a = enqueue(q, "a", 5);
+  int b = enqueue(q, "b", 5);
+  int c = enqueue(q, "c", 1);
+  assert(a == 0 && b == 1 && c == 2);
+  assert(updatePriority(q, c, 10) == 0);
+  assert(strcmp(front(q), "c") == 0);
+  assert(updatePriority(q, c, 5) == 0);
+  assert(strcmp(front(q), "a") == 0);
+  assert(strcmp(removeHandle(q, a), "a") == 0);
+  assert(removeHandle(q, a) == NULL);
+  assert(updatePriority(q, a, 3) == 1);
+  assert(updatePriority(q, -1, 3) == 1);
+  assert(size(q) == 2);
+  assert(strcmp(dequeue(q), "b") == 0);
+  assert(strcmp(dequeue(q), "c") == 0);
+
+  // Random updates and removals keep the heap consistent
+  srand(1);
+  int handles[100];
+  int priorities[100];
+  for (int i = 0; i < 100; i++) {
+    priorities[i] = rand() % 50;
+    handles[i] = enqueue(q, names[i], priorities[i]);
+  }
+  for (int i = 0; i < 100; i += 3) {
+    priorities[i] = rand() % 50;
+    updatePriority(q, handles[i], priorities[i]);
+  }
+  for (int i = 1; i < 100; i += 4) {
+    removeHandle(q, handles[i]);
+    priorities[i] = -1;
+  }
+  lastPriority = 50;
+  while (!isEmpty(q)) {
+    int index = atoi(dequeue(q));
+    assert(priorities[index] >= 0 && priorities[index] <= lastPriority);
+    lastPriority = priorities[index];
+  }
+
   free(q);
   printf("All tests passed successfully.\n");
 
@@ -0,0 +1,458 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/** The number of bits of a deadline covered by each level of a timing wheel. */
+#define SLOT_BITS 8
+#define SLOTS (1 << SLOT_BITS)
+/** Enough levels to cover every 64-bit deadline. */
+#define LEVELS (64 / SLOT_BITS)
+
+/**
+ * A timer that can be scheduled on a timing wheel. Timers are owned by the
+ * caller and linked into the wheel in place, so scheduling one never allocates.
+ *
+ * A timer must be set up with `initTimer` before its first use, since whether
+ * it is scheduled is read from its links.
+ */
+typedef struct Timer {
+  uint64_t deadline;
+  struct Timer *prev; // `NULL` while the timer isn't scheduled
+  struct Timer *next;
+  void (*callback)(struct Timer *timer);
+  void *data;
+} Timer;
+
+/**
+ * A hierarchical timing wheel: a set of timers that expire at integer tick
+ * deadlines. Each level is a circular array of `SLOTS` slots, and each slot is
+ * a circular doubly-linked list of timers behind a sentinel node, so timers can
+ * be scheduled and cancelled in O(1).
+ *
+ * A timer is kept on the lowest level whose slot range still contains its
+ * deadline: level `k` holds timers whose deadlines share every bit above
+ * `SLOT_BITS * (k + 1)` with the current tick, in slot number
+ * `(deadline >> SLOT_BITS * k) % SLOTS`. When the current tick reaches the
+ * start of a higher-level slot, that slot's timers cascade down to lower
+ * levels, and every tick expires one level-0 slot as a batch.
+ */
+typedef struct TimingWheel {
+  uint64_t now;
+  int length;
+  Timer slots[LEVELS][SLOTS];
+} TimingWheel;
+
+/** Empties a slot by pointing its sentinel at itself. */
+static void resetSlot(Timer *sentinel) {
+  sentinel->prev = sentinel;
+  sentinel->next = sentinel;
+}
+
+/** Links a timer into a slot, before its sentinel (i.e. at the back). */
+static void linkTimer(Timer *sentinel, Timer *timer) {
+  timer->prev = sentinel->prev;
+  timer->next = sentinel;
+  sentinel->prev->next = timer;
+  sentinel->prev = timer;
+}
+
+/** Unlinks a timer from whichever slot it's in. */
+static void unlinkTimer(Timer *timer) {
+  timer->prev->next = timer->next;
+  timer->next->prev = timer->prev;
+  timer->prev = NULL;
+  timer->next = NULL;
+}
+
+/**
+ * Constructs a new instance of a timing wheel starting at a given tick and
+ * returns a pointer to it. (Make sure to `free` the pointer once you're
+ * finished with it.)
+ */
+TimingWheel *newTimingWheel(uint64_t now) {
+  TimingWheel *ptr = malloc(sizeof(TimingWheel));
+
+  ptr->now = now;
+  ptr->length = 0;
+  for (int level = 0; level < LEVELS; level++) {
+    for (int slot = 0; slot < SLOTS; slot++) {
+      resetSlot(&ptr->slots[level][slot]);
+    }
+  }
+
+  return ptr;
+}
+
+/** Returns the number of timers scheduled on a timing wheel. */
+int size(TimingWheel *wheel) { return wheel->length; }
+
+/** Returns whether or not a timing wheel has no timers scheduled. */
+bool isEmpty(TimingWheel *wheel) { return size(wheel) == 0; }
+
+/** Sets up an unscheduled timer, carrying some data for its callback. */
+void initTimer(Timer *timer, void *data) {
+  timer->prev = NULL;
+  timer->next = NULL;
+  timer->callback = NULL;
+  timer->data = data;
+}
+
+/** Returns whether or not a timer is currently scheduled. */
+bool isScheduled(Timer *timer) { return timer->prev != NULL; }
+
+/** Links a timer into the slot for its deadline, given the wheel's tick. */
+static void place(TimingWheel *wheel, Timer *timer) {
+  int level = 0;
+  while (level < LEVELS - 1 &&
+         (timer->deadline >> SLOT_BITS * (level + 1)) !=
+             (wheel->now >> SLOT_BITS * (level + 1))) {
+    level++;
+  }
+
+  int slot = (timer->deadline >> SLOT_BITS * level) & (SLOTS - 1);
+  linkTimer(&wheel->slots[level][slot], timer);
+}
+
+/**
+ * Schedules a timer to expire at a given tick. Deadlines that have already
+ * passed will expire on the next tick.
+ *
+ * @param wheel A pointer to the timing wheel.
+ * @param timer A pointer to a timer that has been set up with `initTimer`.
+ * @param deadline The tick at which the timer should expire.
+ * @param callback The function to call with the timer when it expires.
+ * @return `0` if the timer was successfully scheduled, `1` if it was already
+ *   scheduled.
+ */
+int schedule(TimingWheel *wheel, Timer *timer, uint64_t deadline,
+             void (*callback)(Timer *timer)) {
+  if (isScheduled(timer)) {
+    printf("Schedule error: timer is already scheduled.\n");
+    return 1;
+  }
+
+  timer->deadline = deadline > wheel->now ? deadline : wheel->now + 1;
+  timer->callback = callback;
+  place(wheel, timer);
+  wheel->length++;
+
+  return 0;
+}
+
+/**
+ * Cancels a scheduled timer without calling its callback.
+ *
+ * @param wheel A pointer to the timing wheel.
+ * @param timer A pointer to the timer.
+ * @return `0` if the timer was successfully cancelled, `1` if it wasn't
+ *   scheduled.
+ */
+int cancel(TimingWheel *wheel, Timer *timer) {
+  if (!isScheduled(timer))
+    return 1;
+
+  unlinkTimer(timer);
+  wheel->length--;
+
+  return 0;
+}
+
+/**
+ * Moves every timer out of a slot and into a detached list, so that callbacks
+ * can safely schedule timers into the same slot while the list is processed.
+ */
+static void detachSlot(Timer *sentinel, Timer *detached) {
+  if (sentinel->next == sentinel) {
+    resetSlot(detached);
+    return;
+  }
+
+  detached->next = sentinel->next;
+  detached->prev = sentinel->prev;
+  detached->next->prev = detached;
+  detached->prev->next = detached;
+  resetSlot(sentinel);
+}
+
+/**
+ * Advances a timing wheel to a given tick, one tick at a time, expiring every
+ * timer whose deadline is reached along the way. Each expired timer is
+ * unscheduled before its callback is called, so the callback may reschedule it.
+ *
+ * @param wheel A pointer to the timing wheel.
+ * @param now The tick to advance to.
+ * @return The number of timers that expired.
+ */
+int advance(TimingWheel *wheel, uint64_t now) {
+  int expired = 0;
+  Timer detached;
+
+  while (wheel->now < now) {
+    wheel->now++;
+
+    // Cascade any higher-level slots that start at this tick, largest first
+    int top = 0;
+    while (top < LEVELS - 1 &&
+           (wheel->now & (((uint64_t)1 << SLOT_BITS * (top + 1)) - 1)) == 0) {
+      top++;
+    }
+    for (int level = top; level > 0; level--) {
+      int slot = (wheel->now >> SLOT_BITS * level) & (SLOTS - 1);
+      detachSlot(&wheel->slots[level][slot], &detached);
+      while (detached.next != &detached) {
+        Timer *timer = detached.next;
+        unlinkTimer(timer);
+        place(wheel, timer);
+      }
+    }
+
+    // Expire this tick's batch
+    detachSlot(&wheel->slots[0][wheel->now & (SLOTS - 1)], &detached);
+    while (detached.next != &detached) {
+      Timer *timer = detached.next;
+      unlinkTimer(timer);
+      wheel->length--;
+      expired++;
+      timer->callback(timer);
+    }
+  }
+
+  return expired;
+}
+
+/*
+ * The approach a timing wheel replaces, for benchmarking: a binary min heap of
+ * timer IDs keyed by deadline, with a position table so that timers can be
+ * cancelled in O(log n).
+ */
+typedef struct TimerHeap {
+  int length;
+  int *ids;
+  uint64_t *deadlines; // Indexed by timer ID
+  int *positions;      // Indexed by timer ID; `-1` if not scheduled
+} TimerHeap;
+
+static void heapPlace(TimerHeap *heap, int index, int id) {
+  heap->ids[index] = id;
+  heap->positions[id] = index;
+}
+
+static void heapSiftUp(TimerHeap *heap, int index, int id) {
+  while (index > 0) {
+    int parent = (index - 1) / 2;
+    if (heap->deadlines[heap->ids[parent]] <= heap->deadlines[id])
+      break;
+    heapPlace(heap, index, heap->ids[parent]);
+    index = parent;
+  }
+  heapPlace(heap, index, id);
+}
+
+static void heapSiftDown(TimerHeap *heap, int index, int id) {
+  while (2 * index + 1 < heap->length) {
+    int child = 2 * index + 1;
+    if (child + 1 < heap->length && heap->deadlines[heap->ids[child + 1]] <
+                                        heap->deadlines[heap->ids[child]])
+      child++;
+    if (heap->deadlines[id] <= heap->deadlines[heap->ids[child]])
+      break;
+    heapPlace(heap, index, heap->ids[child]);
+    index = child;
+  }
+  heapPlace(heap, index, id);
+}
+
+static void heapRemoveAt(TimerHeap *heap, int index) {
+  heap->positions[heap->ids[index]] = -1;
+  int last = heap->ids[--heap->length];
+  if (index < heap->length) {
+    if (index > 0 &&
+        heap->deadlines[last] < heap->deadlines[heap->ids[(index - 1) / 2]])
+      heapSiftUp(heap, index, last);
+    else
+      heapSiftDown(heap, index, last);
+  }
+}
+
+static double secondsSince(struct timespec *start) {
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void ignore(Timer *timer) { (void)timer; }
+
+/**
+ * Schedules `n` timers with deadlines spread over a minute of millisecond
+ * ticks, cancels 95% of them, then runs the clock until the rest expire, on
+ * both a timing wheel and a heap.
+ */
+static void benchmark(int n) {
+  const uint64_t horizon = 60000;
+  uint64_t *deadlines = malloc(n * sizeof(uint64_t));
+  srand(42);
+  for (int i = 0; i < n; i++) {
+    deadlines[i] = 1 + ((uint64_t)rand() * RAND_MAX + rand()) % horizon;
+  }
+
+  struct timespec start;
+  double scheduleTime, cancelTime, expireTime;
+
+  // Timing wheel
+  TimingWheel *wheel = newTimingWheel(0);
+  Timer *timers = malloc(n * sizeof(Timer));
+  for (int i = 0; i < n; i++) {
+    initTimer(&timers[i], NULL);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < n; i++) {
+    schedule(wheel, &timers[i], deadlines[i], ignore);
+  }
+  scheduleTime = secondsSince(&start);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < n; i++) {
+    if (i % 20 != 0)
+      cancel(wheel, &timers[i]);
+  }
+  cancelTime = secondsSince(&start);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  int wheelExpired = advance(wheel, horizon);
+  expireTime = secondsSince(&start);
+
+  printf("timing wheel: schedule %.3fs, cancel %.3fs, expire %.3fs\n",
+         scheduleTime, cancelTime, expireTime);
+  free(timers);
+  free(wheel);
+
+  // Heap
+  TimerHeap heap = {0, malloc(n * sizeof(int)), deadlines,
+                    malloc(n * sizeof(int))};
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < n; i++) {
+    heap.length++;
+    heapSiftUp(&heap, heap.length - 1, i);
+  }
+  scheduleTime = secondsSince(&start);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < n; i++) {
+    if (i % 20 != 0)
+      heapRemoveAt(&heap, heap.positions[i]);
+  }
+  cancelTime = secondsSince(&start);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  int heapExpired = 0;
+  for (uint64_t now = 1; now <= horizon; now++) {
+    while (heap.length > 0 && heap.deadlines[heap.ids[0]] <= now) {
+      heapRemoveAt(&heap, 0);
+      heapExpired++;
+    }
+  }
+  expireTime = secondsSince(&start);
+
+  printf("binary heap:  schedule %.3fs, cancel %.3fs, expire %.3fs\n",
+         scheduleTime, cancelTime, expireTime);
+  free(heap.ids);
+  free(heap.positions);
+  free(deadlines);
+
+  assert(wheelExpired == heapExpired);
+}
+
+static int fired;
+static TimingWheel *testWheel;
+
+static void countFired(Timer *timer) {
+  fired++;
+  assert(timer->deadline == *(uint64_t *)timer->data);
+  assert(timer->deadline == testWheel->now);
+}
+
+static void reschedule(Timer *timer) {
+  fired++;
+  TimingWheel *wheel = timer->data;
+  if (fired < 3)
+    schedule(wheel, timer, wheel->now, reschedule);
+}
+
+int main(int argc, char *argv[]) {
+  TimingWheel *w = newTimingWheel(100);
+  testWheel = w;
+
+  assert(isEmpty(w));
+  assert(advance(w, 200) == 0);
+
+  // Deadlines spread across several levels expire exactly on time
+  uint64_t deadlines[] = {201, 455, 456, 512, 70000, 200 + (1 << 24), 300};
+  int numTimers = sizeof(deadlines) / sizeof(deadlines[0]);
+  Timer timers[numTimers];
+  for (int i = 0; i < numTimers; i++) {
+    initTimer(&timers[i], &deadlines[i]);
+    assert(schedule(w, &timers[i], deadlines[i], countFired) == 0);
+  }
+  assert(schedule(w, &timers[0], 500, countFired) == 1);
+  assert(size(w) == numTimers);
+
+  // Cancelled timers never fire
+  assert(cancel(w, &timers[6]) == 0);
+  assert(cancel(w, &timers[6]) == 1);
+  assert(!isScheduled(&timers[6]));
+
+  fired = 0;
+  assert(advance(w, 454) == 1);
+  assert(advance(w, 455) == 1);
+  assert(advance(w, 511) == 1);
+  assert(advance(w, 512) == 1);
+  assert(advance(w, 69999) == 0);
+  assert(advance(w, 70000) == 1);
+  assert(advance(w, 199 + (1 << 24)) == 0);
+  assert(advance(w, 200 + (1 << 24)) == 1);
+  assert(fired == 6);
+  assert(isEmpty(w));
+
+  // Past deadlines fire on the next tick, and callbacks may reschedule
+  fired = 0;
+  timers[0].data = w;
+  schedule(w, &timers[0], 0, reschedule);
+  assert(advance(w, w->now + 10) == 3);
+  assert(fired == 3);
+  assert(isEmpty(w));
+
+  free(w);
+
+  // Random deadlines expire in order
+  w = newTimingWheel(0);
+  testWheel = w;
+  Timer many[1000];
+  uint64_t manyDeadlines[1000];
+  srand(7);
+  for (int i = 0; i < 1000; i++) {
+    manyDeadlines[i] = 1 + rand() % 200000;
+    initTimer(&many[i], &manyDeadlines[i]);
+    schedule(w, &many[i], manyDeadlines[i], countFired);
+  }
+  fired = 0;
+  for (uint64_t now = 0; now < 200000; now += 997) {
+    advance(w, now);
+  }
+  advance(w, 200000);
+  assert(fired == 1000);
+
+  free(w);
+  printf("All tests passed successfully.\n");
+
+  // Pass `bench [number of timers]` to compare against a heap
+  if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    benchmark(argc > 2 ? atoi(argv[2]) : 1000000);
+
+  return 0;
+}